@@ -0,0 +1,202 @@
+#!/bin/sh
+# -------------------------------
+# Strong- and weak-scaling benchmark for the brain simulator
+# -------------------------------
+#
+# Runs brain_serial in fixed-iteration mode over a set of rank counts and
+# graph sizes, collects throughput, memory high-water mark and phase times
+# from --stats-json, and compares throughput with bench/baselines.csv.
+#
+#   sh bench/run_bench.sh                    run and compare
+#   sh bench/run_bench.sh --update-baseline  run and store as new baseline
+#   EXCHANGES="p2p neighbor rma" sh bench/run_bench.sh
+#                                            also compare exchange modes on
+#                                            the same graphs
+#   KERNEL_VARIANTS="specialised generic" sh bench/run_bench.sh
+#                                            also run brain_serial_generic
+#                                            (make bench-kernels)
+#   ENGINES="mpi shm" sh bench/run_bench.sh  also run brain_shm with one thread
+#                                            per rank (make bench-shm)
+#
+# Environment overrides:
+#   RANKS="1 2 4"        rank counts
+#   ITERATIONS=200       iterations per run
+#   STRONG_NODES=2000    total nodes for strong scaling
+#   WEAK_NODES=500       nodes per rank for weak scaling
+#   DEGREE=20            mean edges per node of generated graphs
+#   TOLERANCE=0.10       allowed throughput drop before flagging
+#   MPIRUN="mpirun"      launcher, MPIRUN_FLAGS for extra flags
+#   EXCHANGES="p2p"      --exchange modes to run; cases for modes other
+#                        than p2p are labelled <mode>-<exchange>
+#   KERNEL_VARIANTS="specialised"
+#                        propagation kernel builds to run; generic runs
+#                        brain_serial_generic and is labelled <mode>-generic
+#   ENGINES="mpi"        engines to run; brain_serial always runs, shm adds
+#                        brain_shm with --threads <ranks>, labelled <mode>-shm
+#
+# Results go to bench/work/results.csv. Baselines are machine specific,
+# so generate them with `make bench-baseline` on the host you compare on.
+
+set -e
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+ROOT_DIR=$(dirname "$BENCH_DIR")
+WORK_DIR="$BENCH_DIR/work"
+BASELINE="$BENCH_DIR/baselines.csv"
+RESULTS="$WORK_DIR/results.csv"
+
+RANKS=${RANKS:-"1 2 4"}
+ITERATIONS=${ITERATIONS:-200}
+STRONG_NODES=${STRONG_NODES:-2000}
+WEAK_NODES=${WEAK_NODES:-500}
+DEGREE=${DEGREE:-20}
+TOLERANCE=${TOLERANCE:-0.10}
+MPIRUN=${MPIRUN:-mpirun}
+EXCHANGES=${EXCHANGES:-p2p}
+KERNEL_VARIANTS=${KERNEL_VARIANTS:-specialised}
+ENGINES=${ENGINES:-mpi}
+MPIRUN_FLAGS=${MPIRUN_FLAGS:-"--oversubscribe"}
+if [ "$(id -u)" = "0" ]; then
+    MPIRUN_FLAGS="$MPIRUN_FLAGS --allow-run-as-root"
+fi
+
+UPDATE=0
+[ "$1" = "--update-baseline" ] && UPDATE=1
+
+SIM="$ROOT_DIR/brain_serial"
+SHM="$ROOT_DIR/brain_shm"
+GEN="$ROOT_DIR/brain_graphgen"
+mkdir -p "$WORK_DIR"
+
+# Neurons/nerves split 85/15 like the shipped graphs
+make_graph() {
+    nodes=$1
+    file="$WORK_DIR/graph_$nodes"
+    if [ ! -f "$file" ]; then
+        nerves=$((nodes * 15 / 100))
+        "$GEN" --neurons $((nodes - nerves)) --nerves "$nerves" --degree "$DEGREE" \
+               --locality 0.5 --seed 42 -o "$file"
+    fi
+    echo "$file"
+}
+
+# Pull a number out of the stats JSON: json_value <file> <key> [<field>]
+json_value() {
+    if [ -n "$3" ]; then
+        grep "\"$2\"" "$1" | sed "s/.*\"$3\": \([-0-9.e+]*\).*/\1/" | head -1
+    else
+        grep "\"$2\"" "$1" | sed "s/.*\"$2\": \([-0-9.e+]*\).*/\1/" | head -1
+    fi
+}
+
+run_case() {
+    mode=$1 nodes=$2 ranks=$3 exchange=$4 kernels=${5:-specialised}
+    [ "$exchange" != "p2p" ] && mode="$mode-$exchange"
+    sim="$SIM"
+    if [ "$kernels" != "specialised" ]; then
+        mode="$mode-$kernels"
+        sim="${SIM}_$kernels"
+    fi
+    graph=$(make_graph "$nodes")
+    run_dir="$WORK_DIR/run_${mode}_${nodes}_${ranks}"
+    mkdir -p "$run_dir"
+
+    if [ "$exchange" = "shm" ]; then
+        launch="$SHM"
+        engine_flags="--threads $ranks"
+    else
+        launch="$MPIRUN $MPIRUN_FLAGS -np $ranks $sim"
+        engine_flags="--exchange $exchange"
+    fi
+
+    (cd "$run_dir" && $launch "$graph" 1000000 \
+        --iterations "$ITERATIONS" $engine_flags --stats-json stats.json > run.log 2>&1) || {
+        echo "  $mode nodes=$nodes ranks=$ranks FAILED (see $run_dir/run.log)" >&2
+        return 1
+    }
+
+    stats="$run_dir/stats.json"
+    sps=$(json_value "$stats" run signals_per_second)
+    rss=$(json_value "$stats" run max_rss_kb)
+    secs=$(json_value "$stats" run seconds)
+    neuron=$(json_value "$stats" neuron_update mean)
+    send=$(json_value "$stats" send mean)
+    recv=$(json_value "$stats" receive mean)
+    barrier=$(json_value "$stats" barrier mean)
+
+    echo "$mode,$nodes,$ranks,$ITERATIONS,$secs,$sps,$rss,$neuron,$send,$recv,$barrier" >> "$RESULTS"
+    printf "  %-15s nodes=%-7s ranks=%-3s %14.0f signals/s  %8s KB  %8.3f s\n" "$mode" "$nodes" "$ranks" "$sps" "$rss" "$secs"
+}
+
+echo "mode,nodes,ranks,iterations,seconds,signals_per_second,max_rss_kb,neuron_update_s,send_s,receive_s,barrier_s" > "$RESULTS"
+
+echo "Strong scaling ($STRONG_NODES nodes, $ITERATIONS iterations)"
+for r in $RANKS; do
+    for x in $EXCHANGES; do
+        for k in $KERNEL_VARIANTS; do
+            run_case strong "$STRONG_NODES" "$r" "$x" "$k"
+        done
+    done
+    for e in $ENGINES; do
+        [ "$e" = "shm" ] && run_case strong "$STRONG_NODES" "$r" shm
+    done
+done
+
+echo "Weak scaling ($WEAK_NODES nodes per rank, $ITERATIONS iterations)"
+for r in $RANKS; do
+    for x in $EXCHANGES; do
+        for k in $KERNEL_VARIANTS; do
+            run_case weak $((WEAK_NODES * r)) "$r" "$x" "$k"
+        done
+    done
+    for e in $ENGINES; do
+        [ "$e" = "shm" ] && run_case weak $((WEAK_NODES * r)) "$r" shm
+    done
+done
+
+# Throughput of each exchange mode, kernel build and engine relative to
+# MPI p2p with specialised kernels on the same case
+if [ "$EXCHANGES" != "p2p" ] || [ "$KERNEL_VARIANTS" != "specialised" ] || [ "$ENGINES" != "mpi" ]; then
+    echo "Variants relative to MPI p2p with specialised kernels"
+    awk -F, '
+        FNR == 1 { next }
+        {
+            split($1, parts, "-")
+            key = parts[1] "," $2 "," $3
+            variant = substr($1, length(parts[1]) + 2)
+            if (variant == "") base[key] = $6
+            else { rows[++n] = key; mode[n] = variant; sps[n] = $6 }
+        }
+        END {
+            for (i = 1; i <= n; i++)
+                if (base[rows[i]] > 0)
+                    printf "  %-16s %-20s %6.1f%%\n", mode[i], rows[i], sps[i] / base[rows[i]] * 100
+        }
+    ' "$RESULTS"
+fi
+
+if [ "$UPDATE" = "1" ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "Baseline updated: $BASELINE"
+    exit 0
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    echo "No baseline at $BASELINE; run 'make bench-baseline' to create one"
+    exit 0
+fi
+
+# Flag any case whose throughput fell more than TOLERANCE below its baseline
+awk -F, -v tol="$TOLERANCE" '
+    FNR == 1 { next }
+    NR == FNR { base[$1 "," $2 "," $3] = $6; next }
+    {
+        key = $1 "," $2 "," $3
+        if (!(key in base)) { printf "  %-24s no baseline\n", key; next }
+        ratio = base[key] > 0 ? $6 / base[key] : 1
+        status = ratio < 1 - tol ? "REGRESSION" : "ok"
+        if (status == "REGRESSION") bad++
+        printf "  %-24s %6.1f%% of baseline  %s\n", key, ratio * 100, status
+    }
+    END { if (bad) { printf "%d regression(s) beyond %.0f%%\n", bad, tol * 100; exit 1 } }
+' "$BASELINE" "$RESULTS"
@@ -3,6 +3,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 #include <sys/time.h>
 #include <mpi.h>
@@ -14,10 +16,18 @@
 #define NUM_SIGNAL_TYPES 10
 #define MIN_LENGTH_NS 2
 #define SIGNAL_INBOX_SIZE 16384
-#define MAX_NODE_ID 2048
 #define MAX_RANDOM_NERVE_SIGNALS_TO_FIRE 20
 #define MAX_SIGNAL_VALUE 1000
 #define OUTPUT_REPORT_FILENAME "summary_report"
+#define SIGNAL_TYPE_BITS 4
+
+// State each worker thread of the shared-memory engine (SHM_ENGINE
+// builds) keeps for itself, as each rank does in the MPI build
+#ifdef SHM_ENGINE
+#define WORKER_LOCAL __thread
+#else
+#define WORKER_LOCAL
+#endif
 
 // -------------------------------
 // Enumerations
@@ -26,6 +36,11 @@ enum ReadMode       { NONE, NEURON_NERVE, EDGE };
 enum NeuronType     { SENSORY, MOTOR, UNIPOLAR, PSEUDOUNIPOLAR, BIPOLAR, MULTIPOLAR };
 enum NodeType       { NEURON, NERVE };
 enum EdgeDirection  { BIDIRECTIONAL, UNIDIRECTIONAL };
+enum SignalPrecision { PRECISION_FP32, PRECISION_FP16, PRECISION_BF16 };
+enum ReportFormat   { REPORT_TEXT, REPORT_BINARY, REPORT_FIXED_TEXT };
+enum ExchangeMode   { EXCHANGE_P2P, EXCHANGE_NEIGHBOR, EXCHANGE_RMA };
+enum NodeOrdering   { ORDER_FILE, ORDER_HILBERT, ORDER_RCM };
+enum EdgeFormat     { EDGE_FULL, EDGE_COMPACT };
 
 // -------------------------------
 // Signal Structure
@@ -35,11 +50,18 @@ struct SignalStruct {
     float value;
 };
 
+// Signal addressed to a node by its index on the owning rank
+struct WireSignal {
+    int local_idx;
+    struct SignalStruct signal;
+};
+
 // -------------------------------
 // Edge (Connection)
 // -------------------------------
 struct EdgeStruct {
     int from, to;
+    int from_idx, to_idx;      // dense node indices, resolved at load (-1 if unknown)
     enum EdgeDirection direction;
     float *messageTypeWeightings;
     float max_value;
@@ -84,29 +106,185 @@ typedef struct {
 // -------------------------------
 // Global Brain Data (extern)
 // -------------------------------
-extern struct NeuronNerveStruct *brain_nodes;
+extern WORKER_LOCAL struct NeuronNerveStruct *brain_nodes;
 extern struct EdgeStruct *edges;
 extern int num_neurons, num_nerves, num_edges, num_brain_nodes, elapsed_ns;
 
 // -------------------------------
-// Global ID-to-Index Maps (extern)
+// Run-time Options
+// -------------------------------
+struct SimOptions {
+    enum SignalPrecision precision;
+    const char *stats_json;
+    const char *trace_file;
+    int trace_events;
+    int iterations;
+    const char *checkpoint_prefix;
+    int checkpoint_every_ns;
+    const char *restart_prefix;
+    const char *report_file;
+    enum ReportFormat report_format;
+    const char *telemetry_file;
+    int telemetry_top_k;
+    int rebalance_every;
+    double rebalance_threshold;
+    int progress_thread;
+    enum ExchangeMode exchange;
+    int rma_buffer_kb;
+    int async_lag;
+    int loader_threads;
+    int threads;
+    int replicas;
+    long long seed;                 // -1: seed from the wall clock
+    int huge_pages;
+    enum NodeOrdering reorder;
+    int numa_bind;
+    int numa_report;
+    enum EdgeFormat edge_format;
+};
+
+extern struct SimOptions sim_options;
+int parseOptions(int argc, char **argv);
+void printUsage(const char *prog);
+
+// -------------------------------
+// Instrumentation
+// -------------------------------
+enum Phase {
+    PHASE_NS_ROLLOVER, PHASE_NERVE_UPDATE, PHASE_NEURON_UPDATE,
+    PHASE_SEND, PHASE_RECEIVE, PHASE_BARRIER, PHASE_REBALANCE, PHASE_DRAIN, NUM_PHASES
+};
+
+enum StatCounter {
+    STAT_SIGNALS_GENERATED, STAT_SIGNALS_PROCESSED, STAT_CHUNKS_LOCAL, STAT_CHUNKS_REMOTE,
+    STAT_BYTES_SENT, STAT_INBOX_DROPS, STAT_PEAK_INBOX, STAT_NODES_MIGRATED, STAT_RMA_FALLBACKS, NUM_COUNTERS
+};
+
+struct SimStats {
+    double phase_time[NUM_PHASES];
+    long long counters[NUM_COUNTERS];
+    double run_time;
+    int iterations;
+};
+
+extern WORKER_LOCAL struct SimStats sim_stats;
+void phaseBegin(enum Phase phase);
+void phaseEnd(enum Phase phase);
+const char *phaseName(enum Phase phase);
+void reportStats(const char *json_filename);
+
+// -------------------------------
+// Timeline Tracing
+// -------------------------------
+#define DEFAULT_TRACE_EVENTS 65536
+
+void initTrace(int capacity);
+void traceSetIteration(int iteration);
+void traceRecord(enum Phase phase, double begin, double end);
+void writeTrace(const char *filename);
+void freeTrace();
+
+// -------------------------------
+// Per-ns Telemetry Stream
 // -------------------------------
-extern int *id_to_index_map;
-extern int *id_to_index;
+#define DEFAULT_TELEMETRY_TOP_K 10
+
+void initTelemetry(const char *filename, int top_k, int start_idx, int end_idx);
+void telemetryRecordNs(int ns, int iterations, int total_iterations);
+void telemetrySetRange(int start_idx, int end_idx);
+void finishTelemetry();
 
 // -------------------------------
-// MPI Signal Type
+// Signal Wire Format
 // -------------------------------
-extern MPI_Datatype MPI_PackedSignal;
-void create_mpi_signal_type();
+size_t maxEncodedBatchSize(int count);
+size_t encodeSignalBatch(struct WireSignal *signals, int count, enum SignalPrecision precision, unsigned char *out);
+int decodeSignalBatch(const unsigned char *in, size_t len, void (*deliver)(int local_idx, struct SignalStruct signal));
 
 // -------------------------------
 // Loader Functions
 // -------------------------------
 void loadBrainGraph(char *filename);
 void linkNodesToEdges();
+void broadcastEdges();
 int getNumberOfEdgesForNode(int node_id);
+void buildNodeIdIndex();
 int getNodeIndexById(int id);
+void freeNodeIdIndex();
+
+// -------------------------------
+// Node Ordering
+// -------------------------------
+void reorderNodes(enum NodeOrdering ordering);
+void broadcastNodeOrder(enum NodeOrdering ordering);
+int getNodeFilePosition(int idx);
+int getNodeAtFilePosition(int position);
+void freeNodeOrder();
+
+// -------------------------------
+// Compact Edge Table (--edge-format compact)
+// -------------------------------
+// Reserved 16-bit index for an unknown node; 16-bit tables are only
+// built for graphs with fewer nodes, so no real index collides with it
+#define COMPACT16_NO_NODE 0xFFFF
+
+struct CompactEdge16 {
+    uint16_t from_idx, to_idx;      // COMPACT16_NO_NODE: unknown node
+    uint16_t max_code;
+    uint8_t weight_code[NUM_SIGNAL_TYPES];
+};
+
+struct CompactEdge32 {
+    uint32_t from_idx, to_idx;      // 0xFFFFFFFF: unknown node
+    uint16_t max_code;
+    uint8_t weight_code[NUM_SIGNAL_TYPES];
+};
+
+struct CompactEdgeTable {
+    int index_bits;                 // 16 or 32; 0 when not in use
+    struct CompactEdge16 *e16;
+    struct CompactEdge32 *e32;
+    float weight_value[256];        // weighting for each 8-bit code
+    float max_scale;                // max_value = max_code * max_scale
+};
+
+extern struct CompactEdgeTable compact_edges;
+
+// Dense index of a 16-bit endpoint, -1 for an unknown node
+static inline int compact16Index(uint16_t idx) {
+    return idx == COMPACT16_NO_NODE ? -1 : (int)idx;
+}
+
+void buildCompactEdges();
+void freeCompactEdges();
+
+// -------------------------------
+// Ensembles (--replicas)
+// -------------------------------
+uint64_t getBaseSeed();
+uint64_t getReplicaSeed(int replica);
+void replicaReportName(char *buf, size_t len, int replica);
+void resetNodeState();
+void initEnsemble(int replicas);
+void recordReplica(int replica, int start_idx, int end_idx);
+void reportEnsemble(const char *json_filename);
+void freeEnsemble();
+
+// -------------------------------
+// NUMA Placement
+// -------------------------------
+void bindToNumaNode();
+void reportNumaPlacement(int start_idx, int end_idx);
+
+// -------------------------------
+// Graph Memory
+// -------------------------------
+void allocateGraph(int node_count, int edge_count);
+void allocateEdgeLists();
+void freeEdgeWeights();
+void freeGraph();
+struct NeuronNerveStruct *copyNodeState();
+void freeNodeState(struct NeuronNerveStruct *nodes);
 int neuronTypeToIndex(enum NeuronType type);
 
 // -------------------------------
@@ -116,8 +294,27 @@ void updateNodes(int node_idx);
 void handleSignal(int node_idx, float signal, int signal_type);
 void fireSignal(int node_idx, float signal, int signal_type);
 void generateReport(const char *filename);
+void writeParallelReport(const char *filename, enum ReportFormat format, int start_idx, int end_idx);
 void freeMemory();
 
+// -------------------------------
+// Checkpoint / Restart
+// -------------------------------
+#define CHECKPOINT_MAGIC 0x504b4342u   // "BCKP"
+#define CHECKPOINT_VERSION 3
+
+// Loop counters saved alongside node state
+struct RunProgress {
+    int elapsed_ns;
+    int total_iterations;
+    int current_ns_iterations;
+    int max_iteration_per_ns;
+    int min_iteration_per_ns;
+};
+
+void writeCheckpoint(const char *prefix, int start_idx, int end_idx, const struct RunProgress *progress);
+void readCheckpoint(const char *prefix, int *start_idx, int *end_idx, struct RunProgress *progress);
+
 // -------------------------------
 // Utility Functions
 // -------------------------------
@@ -125,19 +322,65 @@ int getRandomInteger(int min, int max);
 float generateDecimalRandomNumber(int max_val);
 time_t getCurrentSeconds();
 void initialize_random();
+void seedRandom(uint64_t seed);
+void getRandomState(uint64_t state[4]);
+void setRandomState(const uint64_t state[4]);
 
 // -------------------------------
 // Event Handling
 // -------------------------------
-void sendSignalToRank(int tgt_idx, struct SignalStruct signal, int rank, int size);
+void initSignalExchange(int world_size);
+void sendSignalToRank(int tgt_idx, struct SignalStruct signal, int sender_rank, int world_size);
+void flushOutgoingSignals();
+void completeOutgoingSignals();
+void drainSignalExchange();
+void endSignalEpoch();
+void setSignalIteration(int iteration);
+void announceRollover(int iteration);
+int getAnnouncedRollover();
+void waitForPeers(int iteration, int lag);
+void freeSignalExchange();
 void receiveIncomingSignals(int rank);
+void deliverSignal(int idx, struct SignalStruct signal);
 void handle_event(Event *event);
 
+// -------------------------------
+// Communication Progress Thread
+// -------------------------------
+void startProgressThread();
+void progressPostSend(int dest, unsigned char *buf, int len);
+int progressTakeSignals(struct WireSignal **signals, int *capacity, long long *batches);
+void stopProgressThread();
+
+// -------------------------------
+// One-sided Signal Transport
+// -------------------------------
+#define RMA_RECORD_HEADER sizeof(uint32_t)
+#define DEFAULT_RMA_BUFFER_KB 1024
+
+void initRmaExchange(size_t area_bytes);
+int rmaPostBatch(int dest, unsigned char *record, int len);
+void rmaCompleteSends();
+void rmaDrainEpoch(void (*deliver)(int local_idx, struct SignalStruct signal));
+void freeRmaExchange();
+
 // -------------------------------
 // Rank Helpers
 // -------------------------------
 int getOwnerRank(int node_idx, int total_nodes, int world_size);
 int getOwnerRankById(int id);
+int getRankStartIndex(int r);
+void initPartition(int total_nodes);
+void setPartition(const int *starts);
+
+// -------------------------------
+// Load Rebalancing
+// -------------------------------
+#define DEFAULT_REBALANCE_THRESHOLD 1.10
+
+void initRebalance(int start_idx, int end_idx);
+void rebalanceNodes(int *start_idx, int *end_idx, int iteration, double threshold);
+void freeRebalance();
 
 #endif // BRAIN_H
 
@@ -0,0 +1,281 @@
+// -------------------------------
+// brain_sim.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "brain.h"
+#include "brain_sim.h"
+
+// libbrainsim.a behind brain_sim.h. Built like brain_shm, with shm/mpi.h
+// in place of MPI, so a host program links no MPI library. The whole
+// graph belongs to one caller: signals go straight into the target's
+// inbox, as sendSignalToRank does for a rank's own nodes. The loop per
+// iteration is the engines' (nerves, then neurons), and ns rollover
+// happens after a fixed number of iterations or on the engines' wall
+// clock. Node state, statistics and the random stream live on the
+// simulation and are swapped into the module globals, which are per
+// thread in this build, for the duration of each call.
+
+_Static_assert(BRAIN_SIM_SIGNAL_TYPES == NUM_SIGNAL_TYPES, "brain_sim.h signal types out of step");
+
+// Global brain data, pointed at the calling simulation's on entry
+WORKER_LOCAL struct NeuronNerveStruct *brain_nodes = NULL;
+struct EdgeStruct *edges = NULL;
+int num_neurons = 0, num_nerves = 0, num_edges = 0, num_brain_nodes = 0, elapsed_ns = 0;
+
+// The shared modules see a world of one rank
+int rank = 0, size = 1;
+
+struct BrainSim {
+    struct BrainSimConfig config;
+    struct NeuronNerveStruct *nodes;    // NULL until loaded
+    struct SimStats stats;
+    uint64_t random_state[4];
+    long long iterations;
+    int elapsed_ns;
+    int current_ns_iterations;
+    long long signals_injected;
+    time_t seconds, start_seconds;      // wall-clock ns when iterations_per_ns is 0
+};
+
+// The simulation holding the process's graph
+static struct BrainSim *graph_owner = NULL;
+
+static void enterSim(const struct BrainSim *sim) {
+    brain_nodes = sim->nodes;
+    sim_stats = sim->stats;
+    setRandomState(sim->random_state);
+    elapsed_ns = sim->elapsed_ns;
+}
+
+static void leaveSim(struct BrainSim *sim) {
+    sim->stats = sim_stats;
+    getRandomState(sim->random_state);
+}
+
+// -------------------------------
+// Append a signal to a node's inbox, or count it as dropped
+// -------------------------------
+void deliverSignal(int idx, struct SignalStruct signal) {
+    struct NeuronNerveStruct *node = &brain_nodes[idx];
+    if (node->num_outstanding_signals < SIGNAL_INBOX_SIZE) {
+        node->signalInbox[node->num_outstanding_signals++] = signal;
+    } else {
+        sim_stats.counters[STAT_INBOX_DROPS]++;
+        printf("[Rank %d] Signal dropped (inbox full): node %d\n", rank, node->id);
+    }
+}
+
+// -------------------------------
+// Every node is local: deliver now
+// -------------------------------
+void sendSignalToRank(int tgt_idx, struct SignalStruct signal, int sender_rank, int world_size) {
+    (void)sender_rank;
+    (void)world_size;
+
+    if (tgt_idx < 0 || tgt_idx >= num_brain_nodes) {
+        fprintf(stderr, "[Rank %d] Signal for unknown node index %d\n", rank, tgt_idx);
+        return;
+    }
+    sim_stats.counters[STAT_CHUNKS_LOCAL]++;
+    deliverSignal(tgt_idx, signal);
+}
+
+void brainSimDefaultConfig(struct BrainSimConfig *config) {
+    memset(config, 0, sizeof(*config));
+    config->seed = (uint64_t)time(NULL);
+}
+
+struct BrainSim *brainSimCreate(const struct BrainSimConfig *config) {
+    struct BrainSim *sim = calloc(1, sizeof(struct BrainSim));
+    if (!sim)
+        return NULL;
+    if (config)
+        sim->config = *config;
+    else
+        brainSimDefaultConfig(&sim->config);
+    return sim;
+}
+
+// -------------------------------
+// Load, order and link the graph as the engines do, then start from
+// empty state
+// -------------------------------
+int brainSimLoad(struct BrainSim *sim, const char *graph_file) {
+    if (graph_owner) {
+        fprintf(stderr, "[Rank %d] A brain graph is already loaded in this process\n", rank);
+        return -1;
+    }
+    if (access(graph_file, R_OK) != 0) {
+        fprintf(stderr, "[Rank %d] Could not open file %s\n", rank, graph_file);
+        return -1;
+    }
+
+    sim_options.loader_threads = sim->config.loader_threads;
+    sim_options.edge_format = sim->config.compact_edges ? EDGE_COMPACT : EDGE_FULL;
+
+    loadBrainGraph((char *)graph_file);
+    reorderNodes(ORDER_FILE);
+    linkNodesToEdges();
+    if (sim_options.edge_format == EDGE_COMPACT)
+        buildCompactEdges();
+
+    graph_owner = sim;
+    sim->nodes = brain_nodes;
+    brainSimReset(sim, sim->config.seed);
+    return 0;
+}
+
+void brainSimReset(struct BrainSim *sim, uint64_t seed) {
+    if (!sim->nodes)
+        return;
+
+    enterSim(sim);
+    resetNodeState();
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    seedRandom(seed);
+    leaveSim(sim);
+
+    sim->config.seed = seed;
+    sim->iterations = 0;
+    sim->elapsed_ns = 0;
+    sim->current_ns_iterations = 0;
+    sim->signals_injected = 0;
+    sim->start_seconds = sim->seconds = getCurrentSeconds();
+}
+
+// -------------------------------
+// The engines' main loop body, iterations times over every node
+// -------------------------------
+int brainSimStep(struct BrainSim *sim, int iterations) {
+    if (!sim->nodes)
+        return -1;
+
+    enterSim(sim);
+    double start_time = MPI_Wtime();
+
+    for (int n = 0; n < iterations; n++) {
+        phaseBegin(PHASE_NERVE_UPDATE);
+        for (int i = 0; i < num_brain_nodes; i++) {
+            if (brain_nodes[i].node_type == NERVE)
+                updateNodes(i);
+        }
+        phaseEnd(PHASE_NERVE_UPDATE);
+
+        phaseBegin(PHASE_NEURON_UPDATE);
+        for (int i = 0; i < num_brain_nodes; i++) {
+            if (brain_nodes[i].node_type == NEURON)
+                updateNodes(i);
+        }
+        phaseEnd(PHASE_NEURON_UPDATE);
+
+        sim->iterations++;
+        sim->current_ns_iterations++;
+
+        int tick;
+        if (sim->config.iterations_per_ns > 0) {
+            tick = sim->current_ns_iterations >= sim->config.iterations_per_ns;
+        } else {
+            tick = 0;
+            time_t current_seconds = getCurrentSeconds();
+            if (current_seconds != sim->seconds) {
+                sim->seconds = current_seconds;
+                tick = ((sim->seconds - sim->start_seconds) % MIN_LENGTH_NS == 0);
+            }
+        }
+
+        if (tick) {
+            phaseBegin(PHASE_NS_ROLLOVER);
+            for (int i = 0; i < num_brain_nodes; i++) {
+                brain_nodes[i].signals_last_ns = brain_nodes[i].signals_this_ns;
+                brain_nodes[i].signals_this_ns = 0;
+            }
+            sim->elapsed_ns++;
+            sim->current_ns_iterations = 0;
+            phaseEnd(PHASE_NS_ROLLOVER);
+        }
+    }
+
+    sim_stats.run_time += MPI_Wtime() - start_time;
+    sim_stats.iterations = (int)sim->iterations;
+    leaveSim(sim);
+    return sim->elapsed_ns;
+}
+
+int brainSimInject(struct BrainSim *sim, int node_id, int type, float value) {
+    if (!sim->nodes || type < 0 || type >= NUM_SIGNAL_TYPES)
+        return -1;
+    int idx = getNodeIndexById(node_id);
+    if (idx < 0 || sim->nodes[idx].num_outstanding_signals >= SIGNAL_INBOX_SIZE)
+        return -1;
+
+    struct NeuronNerveStruct *node = &sim->nodes[idx];
+    node->signalInbox[node->num_outstanding_signals].type = type;
+    node->signalInbox[node->num_outstanding_signals].value = value;
+    node->num_outstanding_signals++;
+    sim->signals_injected++;
+    return 0;
+}
+
+void brainSimCounters(const struct BrainSim *sim, struct BrainSimCounters *out) {
+    memset(out, 0, sizeof(*out));
+    out->iterations = sim->iterations;
+    out->elapsed_ns = sim->elapsed_ns;
+    out->signals_generated = sim->stats.counters[STAT_SIGNALS_GENERATED];
+    out->signals_injected = sim->signals_injected;
+    out->signals_processed = sim->stats.counters[STAT_SIGNALS_PROCESSED];
+    out->inbox_drops = sim->stats.counters[STAT_INBOX_DROPS];
+    out->peak_inbox_depth = sim->stats.counters[STAT_PEAK_INBOX];
+    out->seconds = sim->stats.run_time;
+}
+
+int brainSimNodeCount(const struct BrainSim *sim) {
+    return sim->nodes ? num_brain_nodes : 0;
+}
+
+int brainSimNodeId(const struct BrainSim *sim, int position) {
+    if (!sim->nodes || position < 0 || position >= num_brain_nodes)
+        return -1;
+    return sim->nodes[getNodeAtFilePosition(position)].id;
+}
+
+int brainSimQueryNode(const struct BrainSim *sim, int node_id, struct BrainSimNode *out) {
+    int idx = sim->nodes ? getNodeIndexById(node_id) : -1;
+    if (idx < 0)
+        return -1;
+
+    const struct NeuronNerveStruct *node = &sim->nodes[idx];
+    out->id = node->id;
+    out->is_nerve = node->node_type == NERVE;
+    out->outstanding_signals = node->num_outstanding_signals;
+    out->total_signals_received = node->total_signals_recieved;
+    out->signals_this_ns = node->signals_this_ns;
+    out->signals_last_ns = node->signals_last_ns;
+    memcpy(out->nerve_inputs, node->num_nerve_inputs, sizeof(out->nerve_inputs));
+    memcpy(out->nerve_outputs, node->num_nerve_outputs, sizeof(out->nerve_outputs));
+    return 0;
+}
+
+void brainSimWriteReport(struct BrainSim *sim, const char *filename) {
+    if (!sim->nodes)
+        return;
+    enterSim(sim);
+    generateReport(filename);
+}
+
+void brainSimDestroy(struct BrainSim *sim) {
+    if (!sim)
+        return;
+    if (graph_owner == sim) {
+        freeMemory();
+        freeNodeIdIndex();
+        freeNodeOrder();
+        freeCompactEdges();
+        num_neurons = num_nerves = num_edges = num_brain_nodes = elapsed_ns = 0;
+        graph_owner = NULL;
+    }
+    free(sim);
+}
@@ -0,0 +1,83 @@
+// -------------------------------
+// brain_sim.h
+// -------------------------------
+//
+// Embedding API of libbrainsim.a: the graph, node and signal modules of
+// the simulator driven from a host program instead of main. A simulation
+// keeps its graph resident between calls and advances only when stepped,
+// so a pipeline can run it in batches, feed it signals and read counters
+// without process startup, parsing or report files per run.
+//
+// There is one loaded graph per process. Calls on a simulation may come
+// from any thread, but not from two at once. Link with -pthread -lm.
+
+#ifndef BRAIN_SIM_H
+#define BRAIN_SIM_H
+
+#include <stdint.h>
+
+#define BRAIN_SIM_SIGNAL_TYPES 10
+
+struct BrainSim;
+
+struct BrainSimConfig {
+    uint64_t seed;
+    int iterations_per_ns;      // 0: a new ns every 2 wall-clock seconds, as the engines do
+    int loader_threads;         // 0: chosen from the file size
+    int compact_edges;          // nonzero: quantised edge table (--edge-format compact)
+};
+
+struct BrainSimCounters {
+    long long iterations;
+    int elapsed_ns;
+    long long signals_generated;    // fired at random by nerves
+    long long signals_injected;     // accepted by brainSimInject
+    long long signals_processed;
+    long long inbox_drops;
+    long long peak_inbox_depth;
+    double seconds;                 // spent in brainSimStep
+};
+
+struct BrainSimNode {
+    int id;
+    int is_nerve;
+    int outstanding_signals;        // queued for the next step
+    int total_signals_received;
+    int signals_this_ns;
+    int signals_last_ns;
+    int nerve_inputs[BRAIN_SIM_SIGNAL_TYPES];   // nerves only
+    int nerve_outputs[BRAIN_SIM_SIGNAL_TYPES];
+};
+
+void brainSimDefaultConfig(struct BrainSimConfig *config);
+
+// NULL config: defaults, seeded from the clock
+struct BrainSim *brainSimCreate(const struct BrainSimConfig *config);
+
+// 0 on success; -1 if the file cannot be read or a graph is already
+// loaded in this process. A malformed graph is fatal, as in the engines
+int brainSimLoad(struct BrainSim *sim, const char *graph_file);
+
+// Run that many iterations; returns the ns elapsed so far, -1 if no graph
+int brainSimStep(struct BrainSim *sim, int iterations);
+
+// Queue a signal for a node, by graph ID, to be handled in the next step.
+// -1 for an unknown node, a bad type or a full inbox
+int brainSimInject(struct BrainSim *sim, int node_id, int type, float value);
+
+// Empty every inbox and counter and reseed, keeping the graph
+void brainSimReset(struct BrainSim *sim, uint64_t seed);
+
+void brainSimCounters(const struct BrainSim *sim, struct BrainSimCounters *out);
+
+// Nodes are numbered 0..count-1 in graph file order
+int brainSimNodeCount(const struct BrainSim *sim);
+int brainSimNodeId(const struct BrainSim *sim, int position);
+int brainSimQueryNode(const struct BrainSim *sim, int node_id, struct BrainSimNode *out);
+
+// The engines' text report of the current state
+void brainSimWriteReport(struct BrainSim *sim, const char *filename);
+
+void brainSimDestroy(struct BrainSim *sim);
+
+#endif // BRAIN_SIM_H
@@ -0,0 +1,262 @@
+// -------------------------------
+// checkpoint.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "brain.h"
+#include <mpi.h>
+
+// Each rank writes <prefix>.<rank> in native byte order:
+//   header        magic, version, world size, rank, node count, nerve count,
+//                 node ordering, struct RunProgress, RNG state, number of
+//                 node records
+//   node records  one per owned node: index, counters, nerve counters,
+//                 inbox length and inbox contents
+// Records carry global node indices, so a restart can repartition them
+// onto any number of ranks. Each rank's records are its contiguous range,
+// so the record counts in the headers give back the partition they were
+// written under, rebalanced or not.
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+struct CheckpointHeader {
+    uint32_t magic, version;
+    int32_t world_size, rank;
+    int32_t num_brain_nodes, num_nerves;
+    int32_t node_ordering;     // enum NodeOrdering the indices refer to
+    struct RunProgress progress;
+    uint64_t random_state[4];
+    int32_t num_records;
+};
+
+// -------------------------------
+// I/O helpers that abort on failure
+// -------------------------------
+static void writeOrDie(FILE *f, const void *data, size_t bytes, const char *path) {
+    if (bytes && fwrite(data, 1, bytes, f) != bytes) {
+        fprintf(stderr, "[Rank %d] Failed writing checkpoint %s\n", rank, path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+static void readOrDie(FILE *f, void *data, size_t bytes, const char *path) {
+    if (bytes && fread(data, 1, bytes, f) != bytes) {
+        fprintf(stderr, "[Rank %d] Truncated or unreadable checkpoint %s\n", rank, path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+static FILE *openCheckpoint(const char *prefix, int r, struct CheckpointHeader *header, char *path, size_t path_len) {
+    snprintf(path, path_len, "%s.%d", prefix, r);
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "[Rank %d] Could not open checkpoint %s\n", rank, path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    readOrDie(f, header, sizeof(*header), path);
+    if (header->magic != CHECKPOINT_MAGIC || header->version != CHECKPOINT_VERSION) {
+        fprintf(stderr, "[Rank %d] %s is not a version %d checkpoint\n", rank, path, CHECKPOINT_VERSION);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (header->num_brain_nodes != num_brain_nodes || header->num_nerves != num_nerves) {
+        fprintf(stderr, "[Rank %d] Checkpoint %s is for a different graph (%d nodes, %d nerves)\n",
+                rank, path, header->num_brain_nodes, header->num_nerves);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (header->node_ordering != (int32_t)sim_options.reorder) {
+        fprintf(stderr, "[Rank %d] Checkpoint %s was written with a different --reorder\n", rank, path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return f;
+}
+
+// -------------------------------
+// Write this rank's state. Files are written under a temporary name and
+// only renamed once every rank has finished, so a crash mid-write leaves
+// the previous checkpoint intact
+// -------------------------------
+void writeCheckpoint(const char *prefix, int start_idx, int end_idx, const struct RunProgress *progress) {
+    char path[512], tmp_path[520];
+    snprintf(path, sizeof(path), "%s.%d", prefix, rank);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *f = fopen(tmp_path, "wb");
+    if (!f) {
+        fprintf(stderr, "[Rank %d] Could not create checkpoint %s\n", rank, tmp_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    struct CheckpointHeader header = {
+        .magic = CHECKPOINT_MAGIC, .version = CHECKPOINT_VERSION,
+        .world_size = size, .rank = rank,
+        .num_brain_nodes = num_brain_nodes, .num_nerves = num_nerves,
+        .node_ordering = sim_options.reorder,
+        .progress = *progress,
+        .num_records = end_idx - start_idx,
+    };
+    getRandomState(header.random_state);
+    writeOrDie(f, &header, sizeof(header), tmp_path);
+
+    for (int i = start_idx; i < end_idx; i++) {
+        struct NeuronNerveStruct *node = &brain_nodes[i];
+        int fields[5] = { i, node->total_signals_recieved, node->signals_this_ns,
+                          node->signals_last_ns, node->num_outstanding_signals };
+        writeOrDie(f, fields, sizeof(fields), tmp_path);
+        writeOrDie(f, node->num_nerve_inputs, NUM_SIGNAL_TYPES * sizeof(int), tmp_path);
+        writeOrDie(f, node->num_nerve_outputs, NUM_SIGNAL_TYPES * sizeof(int), tmp_path);
+        writeOrDie(f, node->signalInbox, node->num_outstanding_signals * sizeof(struct SignalStruct), tmp_path);
+    }
+
+    if (fclose(f) != 0) {
+        fprintf(stderr, "[Rank %d] Failed closing checkpoint %s\n", rank, tmp_path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "[Rank %d] Could not rename checkpoint %s to %s\n", rank, tmp_path, path);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if (rank == 0)
+        printf("[Rank 0] Checkpoint written: %s.* at %d ns, iteration %d\n",
+               prefix, progress->elapsed_ns, progress->total_iterations);
+}
+
+// With the same rank count, adopt the partition the checkpoint was
+// written under (it differs from the even split after a rebalance) and
+// update this rank's range
+static void restoreSavedPartition(const char *prefix, int *start_idx, int *end_idx) {
+    char path[512];
+    int *starts = malloc((size + 1) * sizeof(int));
+    if (!starts) {
+        fprintf(stderr, "[Rank %d] Failed to allocate checkpoint partition\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    starts[0] = 0;
+    for (int r = 0; r < size; r++) {
+        struct CheckpointHeader header;
+        FILE *f = openCheckpoint(prefix, r, &header, path, sizeof(path));
+        fclose(f);
+        if (header.num_records < 0) {
+            fprintf(stderr, "[Rank %d] Corrupt header in %s\n", rank, path);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        starts[r + 1] = starts[r] + header.num_records;
+    }
+    if (starts[size] != num_brain_nodes) {
+        fprintf(stderr, "[Rank %d] Checkpoint %s.* covers %d of %d nodes\n", rank, prefix, starts[size], num_brain_nodes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (starts[rank] != *start_idx || starts[rank + 1] != *end_idx) {
+        setPartition(starts);
+        *start_idx = starts[rank];
+        *end_idx = starts[rank + 1];
+        printf("[Rank %d] Restored checkpoint partition: nodes %d to %d (count = %d)\n",
+               rank, *start_idx, *end_idx - 1, *end_idx - *start_idx);
+    }
+    free(starts);
+}
+
+// -------------------------------
+// Restore state for the nodes this rank owns. With the same rank count
+// the saved partition is restored and only our own file is read;
+// otherwise every file is scanned and records are picked up by node index
+// -------------------------------
+void readCheckpoint(const char *prefix, int *start_out, int *end_out, struct RunProgress *progress) {
+    char path[512];
+    struct CheckpointHeader first;
+    FILE *f = openCheckpoint(prefix, 0, &first, path, sizeof(path));
+    fclose(f);
+
+    int old_size = first.world_size;
+    int repartition = (old_size != size);
+    if (!repartition)
+        restoreSavedPartition(prefix, start_out, end_out);
+
+    int start_idx = *start_out, end_idx = *end_out;
+    int restored = 0;
+    int *counters = malloc(2 * NUM_SIGNAL_TYPES * sizeof(int));
+    if (!counters) {
+        fprintf(stderr, "[Rank %d] Failed to allocate checkpoint read buffer\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // The RNG comes from the rank with our number if there was one;
+    // ranks beyond the old count start a fresh stream
+    if (rank >= old_size)
+        seedRandom((uint64_t)time(NULL) + rank);
+
+    for (int r = 0; r < old_size; r++) {
+        if (!repartition && r != rank)
+            continue;
+
+        struct CheckpointHeader header;
+        f = openCheckpoint(prefix, r, &header, path, sizeof(path));
+        if (header.progress.total_iterations != first.progress.total_iterations || header.world_size != old_size) {
+            fprintf(stderr, "[Rank %d] Checkpoint %s is from a different step than %s.0\n", rank, path, prefix);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+
+        if (r == rank)
+            setRandomState(header.random_state);
+
+        for (int n = 0; n < header.num_records; n++) {
+            int fields[5];
+            readOrDie(f, fields, sizeof(fields), path);
+            readOrDie(f, counters, 2 * NUM_SIGNAL_TYPES * sizeof(int), path);
+
+            int idx = fields[0], inbox = fields[4];
+            if (inbox < 0 || inbox > SIGNAL_INBOX_SIZE || idx < 0 || idx >= num_brain_nodes) {
+                fprintf(stderr, "[Rank %d] Corrupt node record in %s\n", rank, path);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+
+            if (idx < start_idx || idx >= end_idx) {
+                fseek(f, (long)inbox * sizeof(struct SignalStruct), SEEK_CUR);
+                continue;
+            }
+
+            struct NeuronNerveStruct *node = &brain_nodes[idx];
+            node->total_signals_recieved = fields[1];
+            node->signals_this_ns = fields[2];
+            node->signals_last_ns = fields[3];
+            node->num_outstanding_signals = inbox;
+            memcpy(node->num_nerve_inputs, counters, NUM_SIGNAL_TYPES * sizeof(int));
+            memcpy(node->num_nerve_outputs, counters + NUM_SIGNAL_TYPES, NUM_SIGNAL_TYPES * sizeof(int));
+            readOrDie(f, node->signalInbox, inbox * sizeof(struct SignalStruct), path);
+            for (int q = 0; q < inbox; q++) {
+                if (node->signalInbox[q].type < 0 || node->signalInbox[q].type >= NUM_SIGNAL_TYPES) {
+                    fprintf(stderr, "[Rank %d] Corrupt inbox signal in %s\n", rank, path);
+                    MPI_Abort(MPI_COMM_WORLD, 1);
+                }
+            }
+            restored++;
+        }
+
+        fclose(f);
+    }
+
+    free(counters);
+
+    if (restored != end_idx - start_idx) {
+        fprintf(stderr, "[Rank %d] Checkpoint %s.* restored %d of %d owned nodes\n",
+                rank, prefix, restored, end_idx - start_idx);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    *progress = first.progress;
+    if (rank == 0)
+        printf("[Rank 0] Restarted from %s.* (%d ranks -> %d) at %d ns, iteration %d\n",
+               prefix, old_size, size, progress->elapsed_ns, progress->total_iterations);
+}
@@ -0,0 +1,150 @@
+// -------------------------------
+// edge_table.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "brain.h"
+#include <mpi.h>
+
+// Compact edge encoding (--edge-format compact). Each edge becomes one
+// small record holding only what the propagation kernel reads:
+//   endpoints     dense indices, 16-bit when the graph has fewer than
+//                 65535 nodes, else 32-bit; all ones marks an unknown node
+//                 and decodes back to -1
+//   max_value     16-bit code times a per-graph scale
+//   weightings    one 8-bit code per signal type, looked up in a 256-entry
+//                 per-graph table
+// Input files carry two-decimal values, so the codes are chosen to be
+// exact for those (hundredths); any other graph gets a linear fit over
+// its range. The largest error against the full floats is measured when
+// the table is built and printed by rank 0.
+
+#define CENTI_MAX_WEIGHT 255
+#define CENTI_MAX_LIMIT 65535
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank;
+
+struct CompactEdgeTable compact_edges = { 0 };
+
+// Whether every value is a whole number of hundredths no larger than limit
+static int isCenti(float value, int limit) {
+    double hundredths = round((double)value * 100.0);
+    return hundredths >= 0 && hundredths <= limit && (float)(hundredths / 100.0) == value;
+}
+
+static uint8_t weightCode(float w, int centi, float lo, float step) {
+    if (centi)
+        return (uint8_t)round((double)w * 100.0);
+    if (step <= 0)
+        return 0;
+    double q = round((w - lo) / step);
+    return (uint8_t)(q < 0 ? 0 : q > 255 ? 255 : q);
+}
+
+// -------------------------------
+// Build the compact table from edges[] on every rank, then drop the
+// full-precision weightings
+// -------------------------------
+void buildCompactEdges() {
+    freeCompactEdges();
+
+    // --- Pick the encodings ---
+    int centi_weights = 1, centi_limits = 1;
+    float w_lo = 0.0f, w_hi = 0.0f, max_hi = 0.0f;
+    for (int j = 0; j < num_edges; j++) {
+        const struct EdgeStruct *e = &edges[j];
+        if (!isCenti(e->max_value, CENTI_MAX_LIMIT)) centi_limits = 0;
+        if (e->max_value > max_hi) max_hi = e->max_value;
+        for (int t = 0; t < NUM_SIGNAL_TYPES; t++) {
+            float w = e->messageTypeWeightings[t];
+            if (!isCenti(w, CENTI_MAX_WEIGHT)) centi_weights = 0;
+            if ((j == 0 && t == 0) || w < w_lo) w_lo = w;
+            if ((j == 0 && t == 0) || w > w_hi) w_hi = w;
+        }
+    }
+
+    float w_step = (w_hi - w_lo) / 255.0f;
+    for (int q = 0; q < 256; q++)
+        compact_edges.weight_value[q] = centi_weights ? (float)(q / 100.0) : w_lo + q * w_step;
+    compact_edges.max_scale = centi_limits ? 0.01f : (max_hi > 0 ? max_hi / 65535.0f : 0.0f);
+
+    // --- Encode ---
+    compact_edges.index_bits = num_brain_nodes < COMPACT16_NO_NODE ? 16 : 32;
+    size_t record = compact_edges.index_bits == 16 ? sizeof(struct CompactEdge16) : sizeof(struct CompactEdge32);
+    void *table = malloc((num_edges ? num_edges : 1) * record);
+    if (!table) {
+        fprintf(stderr, "[Rank %d] Failed to allocate compact edge table\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    double weight_error = 0.0, limit_error = 0.0, limit_relative = 0.0;
+    int raised_limits = 0;
+    for (int j = 0; j < num_edges; j++) {
+        const struct EdgeStruct *e = &edges[j];
+        uint8_t *codes;
+        uint16_t *max_code;
+        if (compact_edges.index_bits == 16) {
+            struct CompactEdge16 *c = &((struct CompactEdge16 *)table)[j];
+            c->from_idx = e->from_idx < 0 ? COMPACT16_NO_NODE : (uint16_t)e->from_idx;
+            c->to_idx = e->to_idx < 0 ? COMPACT16_NO_NODE : (uint16_t)e->to_idx;
+            codes = c->weight_code;
+            max_code = &c->max_code;
+        } else {
+            struct CompactEdge32 *c = &((struct CompactEdge32 *)table)[j];
+            c->from_idx = (uint32_t)e->from_idx;
+            c->to_idx = (uint32_t)e->to_idx;
+            codes = c->weight_code;
+            max_code = &c->max_code;
+        }
+
+        // A positive limit must stay positive: at zero every chunk would be
+        // empty and the signal would never drop below the firing threshold
+        double m = compact_edges.max_scale > 0 ? round(e->max_value / compact_edges.max_scale) : 0;
+        if (e->max_value > 0 && m < 1) {
+            m = 1;
+            raised_limits++;
+        }
+        *max_code = (uint16_t)(m < 0 ? 0 : m > 65535 ? 65535 : m);
+        double limit = (float)*max_code * compact_edges.max_scale;
+        double err = fabs(limit - e->max_value);
+        if (err > limit_error) limit_error = err;
+        if (e->max_value > 0 && err / e->max_value > limit_relative) limit_relative = err / e->max_value;
+
+        for (int t = 0; t < NUM_SIGNAL_TYPES; t++) {
+            float w = e->messageTypeWeightings[t];
+            codes[t] = weightCode(w, centi_weights, w_lo, w_step);
+            err = fabs((double)compact_edges.weight_value[codes[t]] - w);
+            if (err > weight_error) weight_error = err;
+        }
+    }
+
+    if (compact_edges.index_bits == 16) compact_edges.e16 = table;
+    else compact_edges.e32 = table;
+    freeEdgeWeights();
+
+    if (rank == 0) {
+        size_t full = sizeof(struct EdgeStruct) + NUM_SIGNAL_TYPES * sizeof(float);
+        printf("[Rank 0] Compact edges: %zu bytes/edge (was %zu), %d-bit indices, %s weightings, %s limits\n",
+               record, full, compact_edges.index_bits,
+               centi_weights ? "exact" : "linear 8-bit", centi_limits ? "exact" : "linear 16-bit");
+        printf("[Rank 0] Compact edge error vs float: weighting <= %.3g, max_value <= %.3g (relative %.3g)\n",
+               weight_error, limit_error, limit_relative);
+        if (raised_limits)
+            printf("[Rank 0] Compact edges: %d max_value(s) below one step raised to %.3g\n",
+                   raised_limits, compact_edges.max_scale);
+    }
+}
+
+void freeCompactEdges() {
+    free(compact_edges.e16);
+    free(compact_edges.e32);
+    compact_edges.e16 = NULL;
+    compact_edges.e32 = NULL;
+    compact_edges.index_bits = 0;
+}
@@ -0,0 +1,287 @@
+// -------------------------------
+// ensemble.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "brain.h"
+#include <mpi.h>
+
+// Ensembles (--replicas n): the graph is loaded and shared once, then n
+// replicas run over it, each from empty counters and inboxes with its
+// own random streams. Replica r is seeded from the base seed (--seed,
+// else rank 0's clock) plus r times the golden-ratio increment; every
+// rank or worker thread adds its own index, as a single run does, so a
+// replica can be rerun alone with --seed set to its printed seed.
+// Each replica writes <report>.<r>. recordReplica folds its totals and
+// every node's received count into the ensemble, and reportEnsemble
+// prints mean, standard deviation and range per metric and writes
+// per-node means to <report>.ensemble.
+
+#define SEED_STRIDE 0x9e3779b97f4a7c15ULL
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+struct ReplicaResult {
+    uint64_t seed;
+    int iterations;
+    int elapsed_ns;
+    double seconds;
+    long long counters[NUM_COUNTERS];
+};
+
+static struct ReplicaResult *results = NULL;   // rank 0
+static int num_replicas = 0;
+static double *received_sum = NULL;           // per node, own nodes only until reduced
+static double *received_squares = NULL;
+static uint64_t base_seed = 0;
+static int base_seed_known = 0;
+
+// -------------------------------
+// Collective on first call: the seed every replica derives from
+// -------------------------------
+uint64_t getBaseSeed() {
+    if (!base_seed_known) {
+        long long seed = sim_options.seed >= 0 ? sim_options.seed : (long long)time(NULL);
+        MPI_Bcast(&seed, 1, MPI_LONG_LONG, 0, MPI_COMM_WORLD);
+        base_seed = (uint64_t)seed;
+        base_seed_known = 1;
+    }
+    return base_seed;
+}
+
+uint64_t getReplicaSeed(int replica) {
+    return getBaseSeed() + (uint64_t)replica * SEED_STRIDE;
+}
+
+// Report file of one replica; a single run keeps the plain name
+void replicaReportName(char *buf, size_t len, int replica) {
+    if (sim_options.replicas > 1)
+        snprintf(buf, len, "%s.%d", sim_options.report_file, replica);
+    else
+        snprintf(buf, len, "%s", sim_options.report_file);
+}
+
+// -------------------------------
+// Empty every node's inbox and counters for the next replica
+// -------------------------------
+void resetNodeState() {
+    for (int i = 0; i < num_brain_nodes; i++) {
+        struct NeuronNerveStruct *node = &brain_nodes[i];
+        node->num_outstanding_signals = 0;
+        node->total_signals_recieved = 0;
+        node->signals_this_ns = 0;
+        node->signals_last_ns = 0;
+        memset(node->num_nerve_inputs, 0, NUM_SIGNAL_TYPES * sizeof(int));
+        memset(node->num_nerve_outputs, 0, NUM_SIGNAL_TYPES * sizeof(int));
+    }
+    elapsed_ns = 0;
+}
+
+void initEnsemble(int replicas) {
+    freeEnsemble();
+    num_replicas = replicas;
+    received_sum = calloc(num_brain_nodes ? num_brain_nodes : 1, sizeof(double));
+    received_squares = calloc(num_brain_nodes ? num_brain_nodes : 1, sizeof(double));
+    if (rank == 0)
+        results = calloc(replicas, sizeof(struct ReplicaResult));
+    if (!received_sum || !received_squares || (rank == 0 && !results)) {
+        fprintf(stderr, "[Rank %d] Failed to allocate ensemble statistics\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// -------------------------------
+// Collective: fold a finished replica into the ensemble. Nodes in
+// [start_idx, end_idx) must hold this rank's final state
+// -------------------------------
+void recordReplica(int replica, int start_idx, int end_idx) {
+    long long sums[NUM_COUNTERS], peak;
+    double seconds;
+    MPI_Reduce(sim_stats.counters, sums, NUM_COUNTERS, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&sim_stats.counters[STAT_PEAK_INBOX], &peak, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&sim_stats.run_time, &seconds, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    for (int i = start_idx; i < end_idx; i++) {
+        double received = brain_nodes[i].total_signals_recieved;
+        received_sum[i] += received;
+        received_squares[i] += received * received;
+    }
+
+    if (rank != 0)
+        return;
+
+    struct ReplicaResult *r = &results[replica];
+    r->seed = getReplicaSeed(replica);
+    r->iterations = sim_stats.iterations;
+    r->elapsed_ns = elapsed_ns;
+    r->seconds = seconds;
+    memcpy(r->counters, sums, sizeof(sums));
+    r->counters[STAT_PEAK_INBOX] = peak;
+
+    printf(" Replica %d (seed %llu): %d iterations, %d ns, %lld signals processed, %.0f signals/s\n",
+           replica, (unsigned long long)r->seed, r->iterations, r->elapsed_ns,
+           r->counters[STAT_SIGNALS_PROCESSED],
+           seconds > 0 ? r->counters[STAT_SIGNALS_PROCESSED] / seconds : 0.0);
+}
+
+// -------------------------------
+// Summary of one metric over replicas
+// -------------------------------
+struct Spread {
+    double mean, stddev, min, max;
+};
+
+static struct Spread spreadOf(double (*metric)(const struct ReplicaResult *)) {
+    struct Spread s = { 0 };
+    double sum = 0.0, squares = 0.0;
+    for (int r = 0; r < num_replicas; r++) {
+        double v = metric(&results[r]);
+        sum += v;
+        squares += v * v;
+        if (r == 0 || v < s.min) s.min = v;
+        if (r == 0 || v > s.max) s.max = v;
+    }
+    s.mean = sum / num_replicas;
+    // Sample standard deviation; a single replica has none
+    if (num_replicas > 1) {
+        double var = (squares - sum * sum / num_replicas) / (num_replicas - 1);
+        s.stddev = var > 0 ? sqrt(var) : 0.0;
+    }
+    return s;
+}
+
+static double metricIterations(const struct ReplicaResult *r) { return r->iterations; }
+static double metricElapsedNs(const struct ReplicaResult *r) { return r->elapsed_ns; }
+static double metricSeconds(const struct ReplicaResult *r) { return r->seconds; }
+static double metricGenerated(const struct ReplicaResult *r) { return (double)r->counters[STAT_SIGNALS_GENERATED]; }
+static double metricProcessed(const struct ReplicaResult *r) { return (double)r->counters[STAT_SIGNALS_PROCESSED]; }
+static double metricThroughput(const struct ReplicaResult *r) {
+    return r->seconds > 0 ? r->counters[STAT_SIGNALS_PROCESSED] / r->seconds : 0.0;
+}
+static double metricRemote(const struct ReplicaResult *r) { return (double)r->counters[STAT_CHUNKS_REMOTE]; }
+static double metricDrops(const struct ReplicaResult *r) { return (double)r->counters[STAT_INBOX_DROPS]; }
+static double metricPeakInbox(const struct ReplicaResult *r) { return (double)r->counters[STAT_PEAK_INBOX]; }
+
+static const struct {
+    const char *name;
+    double (*value)(const struct ReplicaResult *);
+} METRICS[] = {
+    { "iterations", metricIterations },
+    { "elapsed_ns", metricElapsedNs },
+    { "seconds", metricSeconds },
+    { "signals_generated", metricGenerated },
+    { "signals_processed", metricProcessed },
+    { "signals_per_second", metricThroughput },
+    { "chunks_remote", metricRemote },
+    { "inbox_drops", metricDrops },
+    { "peak_inbox_depth", metricPeakInbox },
+};
+#define NUM_METRICS ((int)(sizeof(METRICS) / sizeof(METRICS[0])))
+
+// Per-node mean and standard deviation of signals received, in file order
+static void writeNodeSpreads(const char *filename, const double *sum, const double *squares) {
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        fprintf(stderr, "[Rank %d] Failed to open ensemble report: %s\n", rank, filename);
+        return;
+    }
+
+    fprintf(out, "Ensemble of %d replicas with %d neurons, %d nerves and %d total edges (base seed %llu)\n\n",
+            num_replicas, num_neurons, num_nerves, num_edges, (unsigned long long)base_seed);
+
+    for (int pass = 0; pass < 2; pass++) {
+        enum NodeType type = pass == 0 ? NERVE : NEURON;
+        int count = 0;
+        for (int p = 0; p < num_brain_nodes; p++) {
+            int i = getNodeAtFilePosition(p);
+            if (brain_nodes[i].node_type != type)
+                continue;
+            double mean = sum[i] / num_replicas, stddev = 0.0;
+            if (num_replicas > 1) {
+                double var = (squares[i] - sum[i] * sum[i] / num_replicas) / (num_replicas - 1);
+                stddev = var > 0 ? sqrt(var) : 0.0;
+            }
+            fprintf(out, "%s %d (ID: %d), signals received: mean %.2f, stddev %.2f\n",
+                    type == NERVE ? "Nerve" : "Neuron", count++, brain_nodes[i].id, mean, stddev);
+        }
+        if (pass == 0)
+            fprintf(out, "\n");
+    }
+    fclose(out);
+}
+
+// -------------------------------
+// Collective: print and write the ensemble aggregates
+// -------------------------------
+void reportEnsemble(const char *json_filename) {
+    double *sum = NULL, *squares = NULL;
+    if (rank == 0) {
+        sum = malloc((num_brain_nodes ? num_brain_nodes : 1) * sizeof(double));
+        squares = malloc((num_brain_nodes ? num_brain_nodes : 1) * sizeof(double));
+        if (!sum || !squares) {
+            fprintf(stderr, "[Rank %d] Failed to allocate ensemble totals\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Reduce(received_sum, sum, num_brain_nodes, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(received_squares, squares, num_brain_nodes, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank != 0)
+        return;
+
+    struct Spread spreads[NUM_METRICS];
+    for (int m = 0; m < NUM_METRICS; m++)
+        spreads[m] = spreadOf(METRICS[m].value);
+
+    printf("\n Ensemble of %d replicas (base seed %llu):   mean       stddev          min          max\n",
+           num_replicas, (unsigned long long)base_seed);
+    for (int m = 0; m < NUM_METRICS; m++)
+        printf("   %-20s %14.1f %12.1f %12.1f %12.1f\n", METRICS[m].name,
+               spreads[m].mean, spreads[m].stddev, spreads[m].min, spreads[m].max);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s.ensemble", sim_options.report_file);
+    writeNodeSpreads(path, sum, squares);
+    printf(" Per-node ensemble statistics saved to: %s\n", path);
+    free(sum);
+    free(squares);
+
+    if (!json_filename)
+        return;
+
+    FILE *out = fopen(json_filename, "w");
+    if (!out) {
+        fprintf(stderr, "[Rank %d] Failed to open stats file: %s\n", rank, json_filename);
+        return;
+    }
+    fprintf(out, "{\n  \"ranks\": %d,\n  \"replicas\": %d,\n  \"base_seed\": %llu,\n  \"runs\": [\n",
+            size, num_replicas, (unsigned long long)base_seed);
+    for (int r = 0; r < num_replicas; r++) {
+        fprintf(out, "    {\"seed\": %llu", (unsigned long long)results[r].seed);
+        for (int m = 0; m < NUM_METRICS; m++)
+            fprintf(out, ", \"%s\": %.3f", METRICS[m].name, METRICS[m].value(&results[r]));
+        fprintf(out, "}%s\n", r + 1 < num_replicas ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"aggregate\": {\n");
+    for (int m = 0; m < NUM_METRICS; m++)
+        fprintf(out, "    \"%s\": {\"mean\": %.3f, \"stddev\": %.3f, \"min\": %.3f, \"max\": %.3f}%s\n",
+                METRICS[m].name, spreads[m].mean, spreads[m].stddev, spreads[m].min, spreads[m].max,
+                m + 1 < NUM_METRICS ? "," : "");
+    fprintf(out, "  }\n}\n");
+    fclose(out);
+}
+
+void freeEnsemble() {
+    free(results);
+    free(received_sum);
+    free(received_squares);
+    results = NULL;
+    received_sum = received_squares = NULL;
+    num_replicas = 0;
+}
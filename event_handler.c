@@ -14,114 +14,632 @@
 // External Variables
 // -------------------------------
 extern int rank, size;
-extern MPI_Datatype MPI_PackedSignal;
-extern int *id_to_index_map;
-extern int *id_to_index;
 extern int num_brain_nodes;
 
 // -------------------------------
-// Struct for MPI Communication
+// Outgoing batch per destination rank
 // -------------------------------
-typedef struct {
-    int type;
-    int target;
-    float value;
-} PackedSignal;
+struct OutgoingBatch {
+    struct WireSignal *signals;
+    int count, capacity;
+    unsigned char *wire;
+    size_t wire_capacity;
+    MPI_Request request;
+};
+
+static struct OutgoingBatch *outgoing = NULL;
+static int num_outgoing = 0;
+static long long *batches_sent = NULL;   // cumulative, per destination
+static long long batches_received = 0;
+static long long signals_staged = 0;     // remote signals handed to any transport
+static long long signals_delivered = 0;  // remote signals taken off any transport
+static unsigned char *recv_buffer = NULL;
+static int recv_capacity = 0;
+
+// Signals handed over by the progress thread (--progress-thread)
+static struct WireSignal *taken = NULL;
+static int taken_capacity = 0;
+
+// Neighbourhood exchange (--exchange neighbor): ranks we share an edge
+// with, in a distributed graph communicator rebuilt whenever the
+// partition changes
+static MPI_Comm neighbour_comm = MPI_COMM_NULL;
+static int neighbourhood_stale = 1;
+static int num_neighbours = 0;
+static int *neighbours = NULL;
+static int *neighbour_send_counts = NULL, *neighbour_send_displs = NULL;
+static int *neighbour_recv_counts = NULL, *neighbour_recv_displs = NULL;
+static unsigned char *neighbour_send_buf = NULL, *neighbour_recv_buf = NULL;
+static size_t neighbour_send_capacity = 0, neighbour_recv_capacity = 0;
+
+// Bounded-staleness mode (--async-lag): every batch is prefixed with the
+// sender's iteration and the iteration rank 0 has announced for the next
+// ns rollover, and every rank gets a batch (possibly empty) from every
+// other rank each iteration
+#define ASYNC_HEADER (2 * sizeof(int32_t))
+static int *peer_iteration = NULL;      // last iteration received from each rank
+static int send_iteration = 0;
+static int rollover_at = -1;
+
+static void exchangeWithNeighbours();
+static void deliverIncomingSignal(int local_idx, struct SignalStruct signal);
+
+// Contiguous ranges of node indices, one per rank: rank r owns
+// [rank_starts[r], rank_starts[r + 1]). Starts as an even block split
+// and is moved by rebalancing
+static int *rank_starts = NULL;
+static int own_start = 0, own_end = 0;  // this rank's range, for the local fast path
 
 // -------------------------------
-// Get the owning MPI rank of a neuron by its ID
+// Partition of node indices over ranks
 // -------------------------------
-int getOwnerRankById(int id) {
-    if (!id_to_index || id < 0 || id >= MAX_NODE_ID)
+void initPartition(int total_nodes) {
+    free(rank_starts);
+    rank_starts = malloc((size + 1) * sizeof(int));
+    if (!rank_starts) {
+        fprintf(stderr, "[Rank %d] Failed to allocate partition table\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int base = total_nodes / size;
+    int extra = total_nodes % size;
+    for (int r = 0; r <= size; r++)
+        rank_starts[r] = r * base + (r < extra ? r : extra);
+    own_start = rank_starts[rank];
+    own_end = rank_starts[rank + 1];
+    neighbourhood_stale = 1;
+}
+
+void setPartition(const int *starts) {
+    memcpy(rank_starts, starts, (size + 1) * sizeof(int));
+    own_start = rank_starts[rank];
+    own_end = rank_starts[rank + 1];
+    neighbourhood_stale = 1;
+}
+
+int getRankStartIndex(int r) {
+    return rank_starts[r];
+}
+
+int getOwnerRank(int node_idx, int total_nodes, int world_size) {
+    if (node_idx < 0 || node_idx >= total_nodes)
         return -1;
 
-    int global_idx = id_to_index[id];
+    // Last rank whose range starts at or before node_idx; empty ranges
+    // share a start with their successor and are skipped over
+    int lo = 0, hi = world_size - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (rank_starts[mid] <= node_idx) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// -------------------------------
+// Get the owning MPI rank of a neuron by its ID
+// -------------------------------
+int getOwnerRankById(int id) {
+    int global_idx = getNodeIndexById(id);
     if (global_idx == -1)
         return -1;
 
-    int base = num_brain_nodes / size;
-    int extra = num_brain_nodes % size;
+    return getOwnerRank(global_idx, num_brain_nodes, size);
+}
 
-    for (int r = 0; r < size; r++) {
-        int start = r * base + (r < extra ? r : extra);
-        int count = base + (r < extra ? 1 : 0);
-        if (global_idx >= start && global_idx < start + count)
-            return r;
+// -------------------------------
+// Allocate per-destination batches
+// -------------------------------
+void initSignalExchange(int world_size) {
+    num_outgoing = world_size;
+    outgoing = calloc(world_size, sizeof(struct OutgoingBatch));
+    batches_sent = calloc(world_size, sizeof(long long));
+    if (!outgoing || !batches_sent) {
+        fprintf(stderr, "[Rank %d] Failed to allocate outgoing signal batches\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
     }
+    for (int r = 0; r < world_size; r++)
+        outgoing[r].request = MPI_REQUEST_NULL;
 
-    return -1;
+    if (sim_options.async_lag >= 0) {
+        peer_iteration = malloc(world_size * sizeof(int));
+        if (!peer_iteration) {
+            fprintf(stderr, "[Rank %d] Failed to allocate peer iteration table\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        for (int r = 0; r < world_size; r++)
+            peer_iteration[r] = -1;
+    }
+
+    if (sim_options.progress_thread)
+        startProgressThread();
+    if (sim_options.exchange == EXCHANGE_RMA)
+        initRmaExchange((size_t)sim_options.rma_buffer_kb * 1024);
 }
 
 // -------------------------------
-// Send a signal to a local or remote neuron
+// Send a signal to a local or remote neuron by its dense index
 // -------------------------------
-void sendSignalToRank(int tgt_id, struct SignalStruct signal, int sender_rank, int world_size) {
-    int owner = getOwnerRankById(tgt_id);
+void sendSignalToRank(int tgt_idx, struct SignalStruct signal, int sender_rank, int world_size) {
+    // --- Local delivery: straight into the inbox ---
+    if (tgt_idx >= own_start && tgt_idx < own_end) {
+        sim_stats.counters[STAT_CHUNKS_LOCAL]++;
+        deliverSignal(tgt_idx, signal);
+        return;
+    }
+
+    int owner = getOwnerRank(tgt_idx, num_brain_nodes, world_size);
     if (owner == -1) {
-        fprintf(stderr, "[Rank %d] Could not determine owner rank for ID %d\n", sender_rank, tgt_id);
+        fprintf(stderr, "[Rank %d] Could not determine owner rank for index %d\n", sender_rank, tgt_idx);
         return;
     }
 
-    if (owner == sender_rank) {
-        // --- Local delivery ---
-        if (!id_to_index_map || tgt_id < 0 || tgt_id >= MAX_NODE_ID || id_to_index_map[tgt_id] == -1) {
-            fprintf(stderr, "[Rank %d]️ Invalid ID in local sendSignalToRank: %d\n", sender_rank, tgt_id);
-            return;
+    // --- Remote delivery: stage into the owner's batch ---
+    struct OutgoingBatch *batch = &outgoing[owner];
+    if (batch->count == batch->capacity) {
+        int new_capacity = batch->capacity ? batch->capacity * 2 : 256;
+        struct WireSignal *grown = realloc(batch->signals, new_capacity * sizeof(struct WireSignal));
+        if (!grown) {
+            fprintf(stderr, "[Rank %d] realloc failed for outgoing batch to rank %d\n", sender_rank, owner);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        batch->signals = grown;
+        batch->capacity = new_capacity;
+    }
+
+    sim_stats.counters[STAT_CHUNKS_REMOTE]++;
+    signals_staged++;
+    batch->signals[batch->count].local_idx = tgt_idx - getRankStartIndex(owner);
+    batch->signals[batch->count].signal = signal;
+    batch->count++;
+}
+
+// -------------------------------
+// Wait for a previous send while still draining our own inbox,
+// so two ranks waiting on each other cannot deadlock
+// -------------------------------
+static void waitForSend(MPI_Request *request) {
+    int done = 0;
+    while (*request != MPI_REQUEST_NULL) {
+        MPI_Test(request, &done, MPI_STATUS_IGNORE);
+        if (!done)
+            receiveIncomingSignals(rank);
+    }
+}
+
+// -------------------------------
+// Encode and post every non-empty batch
+// -------------------------------
+void flushOutgoingSignals() {
+    if (sim_options.exchange == EXCHANGE_NEIGHBOR) {
+        exchangeWithNeighbours();
+        return;
+    }
+
+    int async = (sim_options.async_lag >= 0);
+
+    for (int r = 0; r < num_outgoing; r++) {
+        struct OutgoingBatch *batch = &outgoing[r];
+        // Async mode sends every peer a batch each iteration, empty or not,
+        // so peers can track how far along we are
+        if (batch->count == 0 && !(async && r != rank))
+            continue;
+
+        // The progress thread sends (and later frees) its own copy, so
+        // there is no previous send to wait for
+        if (sim_options.progress_thread) {
+            unsigned char *wire = malloc(maxEncodedBatchSize(batch->count));
+            if (!wire) {
+                fprintf(stderr, "[Rank %d] Failed to allocate wire buffer to rank %d\n", rank, r);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            size_t len = encodeSignalBatch(batch->signals, batch->count, sim_options.precision, wire);
+            progressPostSend(r, wire, (int)len);
+            batches_sent[r]++;
+            sim_stats.counters[STAT_BYTES_SENT] += (long long)len;
+            batch->count = 0;
+            continue;
+        }
+
+        waitForSend(&batch->request);
+
+        // RMA records carry a length prefix ahead of the batch, async
+        // batches their iteration tags
+        size_t header = (sim_options.exchange == EXCHANGE_RMA) ? RMA_RECORD_HEADER : async ? ASYNC_HEADER : 0;
+        size_t needed = header + maxEncodedBatchSize(batch->count);
+        if (needed > batch->wire_capacity) {
+            unsigned char *grown = realloc(batch->wire, needed);
+            if (!grown) {
+                fprintf(stderr, "[Rank %d] realloc failed for wire buffer to rank %d\n", rank, r);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            batch->wire = grown;
+            batch->wire_capacity = needed;
+        }
+
+        size_t len = encodeSignalBatch(batch->signals, batch->count, sim_options.precision, batch->wire + header);
+        sim_stats.counters[STAT_BYTES_SENT] += (long long)len;
+        batch->count = 0;
+
+        if (async) {
+            int32_t tags[2] = { send_iteration, rollover_at };
+            memcpy(batch->wire, tags, ASYNC_HEADER);
+            MPI_Isend(batch->wire, (int)(ASYNC_HEADER + len), MPI_BYTE, r, TAG_SIGNAL, MPI_COMM_WORLD, &batch->request);
+            batches_sent[r]++;
+            continue;
         }
 
-        int tgt_idx = id_to_index_map[tgt_id];
-        if (tgt_idx < 0 || tgt_idx >= num_brain_nodes) {
-            fprintf(stderr, "[Rank %d]️ Invalid local neuron index: ID %d → index %d\n", sender_rank, tgt_id, tgt_idx);
+        // Batches that do not fit the target's RMA area go two-sided
+        if (header && rmaPostBatch(r, batch->wire, (int)len))
+            continue;
+        if (header)
+            sim_stats.counters[STAT_RMA_FALLBACKS]++;
+
+        MPI_Isend(batch->wire + header, (int)len, MPI_BYTE, r, TAG_SIGNAL, MPI_COMM_WORLD, &batch->request);
+        batches_sent[r]++;
+    }
+
+    if (sim_options.exchange == EXCHANGE_RMA)
+        rmaCompleteSends();
+}
+
+// -------------------------------
+// Bounded-staleness bookkeeping (--async-lag)
+// -------------------------------
+void setSignalIteration(int iteration) {
+    send_iteration = iteration;
+}
+
+// Rank 0 only: schedule the next ns rollover. The value rides on every
+// following batch
+void announceRollover(int iteration) {
+    rollover_at = iteration;
+}
+
+int getAnnouncedRollover() {
+    return rollover_at;
+}
+
+// -------------------------------
+// Keep receiving until every other rank has finished at least
+// iteration - lag. Replaces the end-of-iteration collective
+// -------------------------------
+void waitForPeers(int iteration, int lag) {
+    for (;;) {
+        int behind = 0;
+        for (int r = 0; r < num_outgoing && !behind; r++)
+            behind = (r != rank && peer_iteration[r] < iteration - lag);
+        if (!behind)
             return;
+        receiveIncomingSignals(rank);
+    }
+}
+
+// -------------------------------
+// Close the current RMA epoch and deliver what landed in it. Called by
+// every rank after the collective that ends an iteration
+// -------------------------------
+void endSignalEpoch() {
+    if (sim_options.exchange == EXCHANGE_RMA)
+        rmaDrainEpoch(deliverIncomingSignal);
+}
+
+// -------------------------------
+// Flush and wait until every batch posted by any rank has been received.
+// Per-destination send counts are summed onto their receivers; each rank
+// keeps receiving (so rendezvous sends to it progress) until its count matches
+// -------------------------------
+void completeOutgoingSignals() {
+    flushOutgoingSignals();
+
+    // A neighbourhood exchange is complete when the collective returns
+    if (sim_options.exchange == EXCHANGE_NEIGHBOR)
+        return;
+
+    // Puts are flushed; once every rank is past the barrier they are
+    // all in place
+    if (sim_options.exchange == EXCHANGE_RMA) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        endSignalEpoch();
+    }
+
+    for (int r = 0; r < num_outgoing; r++)
+        waitForSend(&outgoing[r].request);
+
+    long long expected = 0;
+    MPI_Request request;
+    int done = 0;
+    MPI_Ireduce_scatter_block(batches_sent, &expected, 1, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &request);
+    while (!done) {
+        receiveIncomingSignals(rank);
+        MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+    }
+
+    while (batches_received < expected)
+        receiveIncomingSignals(rank);
+}
+
+// -------------------------------
+// End-of-run termination: drain the exchange, then confirm globally
+// that every remote signal staged anywhere has been delivered. Receiving
+// never generates new sends, so the check settles after the first round
+// unless a transport is still holding signals
+// -------------------------------
+void drainSignalExchange() {
+    phaseBegin(PHASE_DRAIN);
+    completeOutgoingSignals();
+
+    long long local[2], global[2];
+    for (;;) {
+        MPI_Request request;
+        int done = 0;
+        local[0] = signals_staged;
+        local[1] = signals_delivered;
+        MPI_Iallreduce(local, global, 2, MPI_LONG_LONG, MPI_SUM, MPI_COMM_WORLD, &request);
+        while (!done) {
+            receiveIncomingSignals(rank);
+            MPI_Test(&request, &done, MPI_STATUS_IGNORE);
         }
+        if (global[0] == global[1])
+            break;
+        if (global[1] > global[0]) {
+            fprintf(stderr, "[Rank %d] Drain delivered %lld signals but only %lld were sent\n",
+                    rank, global[1], global[0]);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    phaseEnd(PHASE_DRAIN);
+}
 
-        Event ev = { .type = EVENT_TYPE_SIGNAL, .target = tgt_idx, .signal = signal };
-        handle_event(&ev);
+void freeSignalExchange() {
+    for (int r = 0; r < num_outgoing; r++) {
+        free(outgoing[r].signals);
+        free(outgoing[r].wire);
+    }
+    stopProgressThread();
+    freeRmaExchange();
+    if (neighbour_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&neighbour_comm);
+    free(neighbours);
+    free(neighbour_send_counts);
+    free(neighbour_send_displs);
+    free(neighbour_recv_counts);
+    free(neighbour_recv_displs);
+    free(neighbour_send_buf);
+    free(neighbour_recv_buf);
+    neighbours = neighbour_send_counts = neighbour_send_displs = NULL;
+    neighbour_recv_counts = neighbour_recv_displs = NULL;
+    neighbour_send_buf = neighbour_recv_buf = NULL;
+    neighbour_send_capacity = neighbour_recv_capacity = 0;
+    num_neighbours = 0;
+    neighbourhood_stale = 1;
+    free(taken);
+    taken = NULL;
+    taken_capacity = 0;
+    free(outgoing);
+    free(batches_sent);
+    free(peer_iteration);
+    peer_iteration = NULL;
+    free(recv_buffer);
+    free(rank_starts);
+    rank_starts = NULL;
+    outgoing = NULL;
+    batches_sent = NULL;
+    recv_buffer = NULL;
+    num_outgoing = recv_capacity = 0;
 
-    } else {
-        // --- Remote delivery ---
-        PackedSignal packed = { .type = signal.type, .target = tgt_id, .value = signal.value };
-        MPI_Send(&packed, 1, MPI_PackedSignal, owner, TAG_SIGNAL, MPI_COMM_WORLD);
+    // Counts restart with the next initSignalExchange (next replica)
+    batches_received = signals_staged = signals_delivered = 0;
+    send_iteration = 0;
+    rollover_at = -1;
+}
+
+// -------------------------------
+// Deliver one decoded signal to an owned node
+// -------------------------------
+static void deliverIncomingSignal(int local_idx, struct SignalStruct signal) {
+    signals_delivered++;
+    if (local_idx < 0 || local_idx >= own_end - own_start || signal.type < 0 || signal.type >= NUM_SIGNAL_TYPES) {
+        fprintf(stderr, "[Rank %d]️ Invalid received signal: local index %d, type %d\n", rank, local_idx, signal.type);
+        return;
+    }
+
+    deliverSignal(own_start + local_idx, signal);
+}
+
+// -------------------------------
+// Neighbourhood exchange. Signals only travel along edges, and firing
+// picks either endpoint, so the rank graph is symmetric: our neighbours
+// are the owners of every node adjacent to one we own
+// -------------------------------
+static void *neighbourAlloc(void *p, size_t bytes) {
+    void *grown = realloc(p, bytes > 0 ? bytes : 1);
+    if (!grown) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %zu bytes for neighbourhood exchange\n", rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return grown;
+}
+
+static void buildNeighbourhood() {
+    // Edges crossing to each rank, passed on as the graph's edge weights
+    int *crossing = calloc(size, sizeof(int));
+    if (!crossing) {
+        fprintf(stderr, "[Rank %d] Failed to allocate crossing-edge counts\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int i = getRankStartIndex(rank); i < getRankStartIndex(rank + 1); i++) {
+        for (int e = 0; e < brain_nodes[i].num_edges; e++) {
+            struct EdgeStruct *edge = &edges[brain_nodes[i].edges[e]];
+            int other = (edge->from_idx == i) ? edge->to_idx : edge->from_idx;
+            int owner = getOwnerRank(other, num_brain_nodes, size);
+            if (owner >= 0 && owner != rank)
+                crossing[owner]++;
+        }
     }
+
+    num_neighbours = 0;
+    neighbours = neighbourAlloc(neighbours, size * sizeof(int));
+    int *weights = neighbourAlloc(NULL, size * sizeof(int));
+    for (int r = 0; r < size; r++) {
+        if (crossing[r]) {
+            weights[num_neighbours] = crossing[r];
+            neighbours[num_neighbours++] = r;
+        }
+    }
+    free(crossing);
+
+    neighbour_send_counts = neighbourAlloc(neighbour_send_counts, num_neighbours * sizeof(int));
+    neighbour_send_displs = neighbourAlloc(neighbour_send_displs, num_neighbours * sizeof(int));
+    neighbour_recv_counts = neighbourAlloc(neighbour_recv_counts, num_neighbours * sizeof(int));
+    neighbour_recv_displs = neighbourAlloc(neighbour_recv_displs, num_neighbours * sizeof(int));
+
+    if (neighbour_comm != MPI_COMM_NULL)
+        MPI_Comm_free(&neighbour_comm);
+    MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD,
+                                   num_neighbours, neighbours, weights,
+                                   num_neighbours, neighbours, weights,
+                                   MPI_INFO_NULL, 0, &neighbour_comm);
+    free(weights);
+    neighbourhood_stale = 0;
 }
 
 // -------------------------------
-// Receive and dispatch incoming MPI signals
+// One sparse collective per iteration: batch sizes, then batches
+// -------------------------------
+static void exchangeWithNeighbours() {
+    if (neighbourhood_stale)
+        buildNeighbourhood();
+
+    size_t needed = 0;
+    for (int k = 0; k < num_neighbours; k++)
+        needed += maxEncodedBatchSize(outgoing[neighbours[k]].count);
+    if (needed > neighbour_send_capacity) {
+        neighbour_send_buf = neighbourAlloc(neighbour_send_buf, needed);
+        neighbour_send_capacity = needed;
+    }
+
+    size_t offset = 0;
+    for (int k = 0; k < num_neighbours; k++) {
+        struct OutgoingBatch *batch = &outgoing[neighbours[k]];
+        size_t len = batch->count ? encodeSignalBatch(batch->signals, batch->count, sim_options.precision,
+                                                      neighbour_send_buf + offset) : 0;
+        neighbour_send_counts[k] = (int)len;
+        neighbour_send_displs[k] = (int)offset;
+        offset += len;
+        sim_stats.counters[STAT_BYTES_SENT] += (long long)len;
+        batch->count = 0;
+    }
+
+    // Anything staged for a rank outside the neighbourhood means the
+    // neighbour set is wrong. Those signals are already counted as staged,
+    // so dropping them would leave the final drain waiting forever
+    for (int r = 0; r < num_outgoing; r++) {
+        if (outgoing[r].count) {
+            fprintf(stderr, "[Rank %d] %d signals staged for non-neighbour rank %d\n", rank, outgoing[r].count, r);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    MPI_Neighbor_alltoall(neighbour_send_counts, 1, MPI_INT, neighbour_recv_counts, 1, MPI_INT, neighbour_comm);
+
+    size_t recv_total = 0;
+    for (int k = 0; k < num_neighbours; k++) {
+        neighbour_recv_displs[k] = (int)recv_total;
+        recv_total += neighbour_recv_counts[k];
+    }
+    if (recv_total > neighbour_recv_capacity) {
+        neighbour_recv_buf = neighbourAlloc(neighbour_recv_buf, recv_total);
+        neighbour_recv_capacity = recv_total;
+    }
+
+    MPI_Neighbor_alltoallv(neighbour_send_buf, neighbour_send_counts, neighbour_send_displs, MPI_BYTE,
+                           neighbour_recv_buf, neighbour_recv_counts, neighbour_recv_displs, MPI_BYTE,
+                           neighbour_comm);
+
+    for (int k = 0; k < num_neighbours; k++) {
+        if (neighbour_recv_counts[k] == 0)
+            continue;
+        if (decodeSignalBatch(neighbour_recv_buf + neighbour_recv_displs[k], (size_t)neighbour_recv_counts[k],
+                              deliverIncomingSignal) < 0)
+            fprintf(stderr, "[Rank %d]️ Malformed signal batch from rank %d (%d bytes)\n",
+                    rank, neighbours[k], neighbour_recv_counts[k]);
+    }
+}
+
+// -------------------------------
+// Receive and dispatch incoming signal batches
 // -------------------------------
 void receiveIncomingSignals(int current_rank) {
     MPI_Status status;
-    int flag;
+    int flag, len;
+
+    // Neighbourhood batches are delivered inside the collective
+    if (sim_options.exchange == EXCHANGE_NEIGHBOR)
+        return;
+
+    if (sim_options.progress_thread) {
+        int count = progressTakeSignals(&taken, &taken_capacity, &batches_received);
+        for (int i = 0; i < count; i++)
+            deliverIncomingSignal(taken[i].local_idx, taken[i].signal);
+        return;
+    }
 
     while (1) {
         MPI_Iprobe(MPI_ANY_SOURCE, TAG_SIGNAL, MPI_COMM_WORLD, &flag, &status);
         if (!flag)
             break;
 
-        PackedSignal recv_signal;
-        MPI_Recv(&recv_signal, 1, MPI_PackedSignal, status.MPI_SOURCE, TAG_SIGNAL, MPI_COMM_WORLD, &status);
+        MPI_Get_count(&status, MPI_BYTE, &len);
+        if (len > recv_capacity) {
+            unsigned char *grown = realloc(recv_buffer, len);
+            if (!grown) {
+                fprintf(stderr, "[Rank %d] realloc failed for receive buffer (%d bytes)\n", current_rank, len);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            recv_buffer = grown;
+            recv_capacity = len;
+        }
 
-        int tgt_id = recv_signal.target;
+        MPI_Recv(recv_buffer, len, MPI_BYTE, status.MPI_SOURCE, TAG_SIGNAL, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        batches_received++;
 
-        // Validate incoming signal target
-        if (!id_to_index_map || tgt_id < 0 || tgt_id >= MAX_NODE_ID || id_to_index_map[tgt_id] == -1) {
-            fprintf(stderr, "[Rank %d]️ Invalid received ID in receiveIncomingSignals: %d\n", current_rank, tgt_id);
-            continue;
+        // Messages between a pair of ranks arrive in order, so the latest
+        // tag is how far that rank has got
+        unsigned char *payload = recv_buffer;
+        if (peer_iteration && len >= (int)ASYNC_HEADER) {
+            int32_t tags[2];
+            memcpy(tags, recv_buffer, ASYNC_HEADER);
+            peer_iteration[status.MPI_SOURCE] = tags[0];
+            if (tags[1] > rollover_at)
+                rollover_at = tags[1];
+            payload += ASYNC_HEADER;
+            len -= (int)ASYNC_HEADER;
         }
 
-        int tgt_idx = id_to_index_map[tgt_id];
-        if (tgt_idx < 0 || tgt_idx >= num_brain_nodes) {
-            fprintf(stderr, "[Rank %d]️ Mapped invalid target index in receiveIncomingSignals: ID %d → index %d\n", current_rank, tgt_id, tgt_idx);
-            continue;
-        }
+        if (decodeSignalBatch(payload, (size_t)len, deliverIncomingSignal) < 0)
+            fprintf(stderr, "[Rank %d]️ Malformed signal batch from rank %d (%d bytes)\n", current_rank, status.MPI_SOURCE, len);
+    }
+}
 
-        struct SignalStruct signal = { .type = recv_signal.type, .value = recv_signal.value };
-        Event ev = { .type = EVENT_TYPE_SIGNAL, .target = tgt_idx, .signal = signal };
-        handle_event(&ev);
+// -------------------------------
+// Queue a signal in an owned node's inbox if there's space. The index is
+// already resolved and range-checked by the caller
+// -------------------------------
+void deliverSignal(int idx, struct SignalStruct signal) {
+    struct NeuronNerveStruct *node = &brain_nodes[idx];
+    if (node->num_outstanding_signals < SIGNAL_INBOX_SIZE) {
+        node->signalInbox[node->num_outstanding_signals++] = signal;
+    } else {
+        sim_stats.counters[STAT_INBOX_DROPS]++;
+        printf("[Rank %d] Signal dropped (inbox full): node %d\n", rank, node->id);
     }
 }
 
 // -------------------------------
-// Central event dispatcher
+// Central event dispatcher. Signals take deliverSignal directly; this
+// is the control path
 // -------------------------------
 void handle_event(Event *event) {
     if (!event)
@@ -129,14 +647,9 @@ void handle_event(Event *event) {
 
     switch (event->type) {
         case EVENT_TYPE_SIGNAL:
-            // Queue signal in inbox if there’s space
             if (event->target < 0 || event->target >= num_brain_nodes)
                 return;
-            if (brain_nodes[event->target].num_outstanding_signals < SIGNAL_INBOX_SIZE) {
-                brain_nodes[event->target].signalInbox[brain_nodes[event->target].num_outstanding_signals++] = event->signal;
-            } else {
-                printf("[Rank %d] Signal dropped (inbox full): node %d\n", rank, brain_nodes[event->target].id);
-            }
+            deliverSignal(event->target, event->signal);
             break;
 
         case EVENT_TYPE_REPORT:
@@ -0,0 +1,184 @@
+// -------------------------------
+// graph_arena.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "brain.h"
+#include <mpi.h>
+
+// All graph and per-node state lives in a handful of blocks sized from
+// the node and edge counts, so loading does no per-node allocation and
+// teardown frees five pointers:
+//   nodes   node structs, then every node's nerve input/output counters
+//   inboxes every node's signal inbox
+//   edges   edge structs
+//   weights every edge's type weightings (released once a compact edge
+//           table has replaced them)
+//   links   every node's edge list, concatenated in node order
+// With --huge-pages all but the inbox block are backed by
+// transparent huge pages. Inboxes never are: each is mostly untouched,
+// and huge pages would fault all of it in.
+
+#define HUGE_PAGE_SIZE (2UL * 1024 * 1024)
+
+enum { BLOCK_NODES, BLOCK_INBOXES, BLOCK_EDGES, BLOCK_WEIGHTS, BLOCK_LINKS, NUM_BLOCKS };
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank;
+
+struct ArenaBlock {
+    void *base;
+    size_t bytes;
+    int mapped;    // mmap'd for huge pages rather than calloc'd
+};
+
+static struct ArenaBlock blocks[NUM_BLOCKS];
+
+// Zeroed block; huge-page eligible blocks are 2 MB aligned so the kernel
+// can back them with huge pages from the first fault
+static void *allocBlock(int which, size_t bytes, int huge) {
+    struct ArenaBlock *block = &blocks[which];
+    if (bytes == 0)
+        bytes = 1;
+
+    if (huge && sim_options.huge_pages && bytes >= HUGE_PAGE_SIZE) {
+        size_t length = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        unsigned char *raw = mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            unsigned char *aligned = (unsigned char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+            if (aligned > raw)
+                munmap(raw, aligned - raw);
+            if (aligned + length < raw + length + HUGE_PAGE_SIZE)
+                munmap(aligned + length, raw + length + HUGE_PAGE_SIZE - (aligned + length));
+            madvise(aligned, length, MADV_HUGEPAGE);
+            block->base = aligned;
+            block->bytes = length;
+            block->mapped = 1;
+            return aligned;
+        }
+    }
+
+    block->base = calloc(1, bytes);
+    if (!block->base) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %zu bytes of graph memory\n", rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    block->bytes = bytes;
+    block->mapped = 0;
+    return block->base;
+}
+
+static void freeBlock(int which) {
+    struct ArenaBlock *block = &blocks[which];
+    if (!block->base)
+        return;
+    if (block->mapped)
+        munmap(block->base, block->bytes);
+    else
+        free(block->base);
+    memset(block, 0, sizeof(*block));
+}
+
+// -------------------------------
+// Allocate brain_nodes and edges with every node's inbox and counters
+// and every edge's weightings already in place and zeroed
+// -------------------------------
+void allocateGraph(int node_count, int edge_count) {
+    freeGraph();
+
+    size_t counters = 2 * NUM_SIGNAL_TYPES * sizeof(int);
+    unsigned char *nodes = allocBlock(BLOCK_NODES, (size_t)node_count * (sizeof(struct NeuronNerveStruct) + counters), 1);
+    struct SignalStruct *inboxes = allocBlock(BLOCK_INBOXES, (size_t)node_count * SIGNAL_INBOX_SIZE * sizeof(struct SignalStruct), 0);
+
+    brain_nodes = (struct NeuronNerveStruct *)nodes;
+    int *counter_base = (int *)(nodes + (size_t)node_count * sizeof(struct NeuronNerveStruct));
+    for (int i = 0; i < node_count; i++) {
+        brain_nodes[i].num_nerve_inputs = counter_base + (size_t)i * 2 * NUM_SIGNAL_TYPES;
+        brain_nodes[i].num_nerve_outputs = brain_nodes[i].num_nerve_inputs + NUM_SIGNAL_TYPES;
+        brain_nodes[i].signalInbox = inboxes + (size_t)i * SIGNAL_INBOX_SIZE;
+    }
+
+    edges = allocBlock(BLOCK_EDGES, (size_t)edge_count * sizeof(struct EdgeStruct), 1);
+    float *weight_base = allocBlock(BLOCK_WEIGHTS, (size_t)edge_count * NUM_SIGNAL_TYPES * sizeof(float), 1);
+    for (int j = 0; j < edge_count; j++)
+        edges[j].messageTypeWeightings = weight_base + (size_t)j * NUM_SIGNAL_TYPES;
+}
+
+// -------------------------------
+// Point every node's edge list into one block. num_edges must be set;
+// the lists are left empty (zeroed) for the caller to fill
+// -------------------------------
+void allocateEdgeLists() {
+    freeBlock(BLOCK_LINKS);
+
+    long long total = 0;
+    for (int i = 0; i < num_brain_nodes; i++)
+        total += brain_nodes[i].num_edges;
+
+    int *links = allocBlock(BLOCK_LINKS, (size_t)total * sizeof(int), 1);
+    for (int i = 0; i < num_brain_nodes; i++) {
+        brain_nodes[i].edges = links;
+        links += brain_nodes[i].num_edges;
+    }
+}
+
+// -------------------------------
+// Drop the full-precision weightings once nothing reads them
+// -------------------------------
+void freeEdgeWeights() {
+    for (int j = 0; j < num_edges; j++)
+        edges[j].messageTypeWeightings = NULL;
+    freeBlock(BLOCK_WEIGHTS);
+}
+
+// -------------------------------
+// An independent copy of every node for an ensemble replica running
+// alongside brain_nodes: loaded fields and edge lists are shared,
+// counters and inboxes are its own and start empty
+// -------------------------------
+struct NeuronNerveStruct *copyNodeState() {
+    size_t n = (size_t)num_brain_nodes;
+    size_t counters = 2 * NUM_SIGNAL_TYPES * sizeof(int);
+    unsigned char *block = calloc(1, (n ? n : 1) * (sizeof(struct NeuronNerveStruct) + counters));
+    struct SignalStruct *inboxes = calloc((n ? n : 1) * SIGNAL_INBOX_SIZE, sizeof(struct SignalStruct));
+    if (!block || !inboxes) {
+        fprintf(stderr, "[Rank %d] Failed to allocate replica node state\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    struct NeuronNerveStruct *nodes = (struct NeuronNerveStruct *)block;
+    int *counter_base = (int *)(block + n * sizeof(struct NeuronNerveStruct));
+    for (size_t i = 0; i < n; i++) {
+        nodes[i] = brain_nodes[i];
+        nodes[i].num_outstanding_signals = 0;
+        nodes[i].total_signals_recieved = 0;
+        nodes[i].signals_this_ns = 0;
+        nodes[i].signals_last_ns = 0;
+        nodes[i].num_nerve_inputs = counter_base + i * 2 * NUM_SIGNAL_TYPES;
+        nodes[i].num_nerve_outputs = nodes[i].num_nerve_inputs + NUM_SIGNAL_TYPES;
+        nodes[i].signalInbox = inboxes + i * SIGNAL_INBOX_SIZE;
+    }
+    // Inboxes are found again through the first node
+    nodes[0].signalInbox = inboxes;
+    return nodes;
+}
+
+void freeNodeState(struct NeuronNerveStruct *nodes) {
+    if (!nodes)
+        return;
+    free(nodes[0].signalInbox);
+    free(nodes);
+}
+
+void freeGraph() {
+    for (int b = 0; b < NUM_BLOCKS; b++)
+        freeBlock(b);
+    brain_nodes = NULL;
+    edges = NULL;
+}
@@ -0,0 +1,339 @@
+// -------------------------------
+// graph_gen.c
+// Synthetic brain graph generator
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+// Emits the same <neuron>/<nerve>/<edge> text format read by loadBrainGraph.
+// Output is fully determined by the options and --seed.
+
+#define NUM_SIGNAL_TYPES 10
+#define NUM_NEURON_TYPES 6
+#define LOCAL_TARGET_ATTEMPTS 8
+
+static const char *NEURON_TYPE_NAMES[NUM_NEURON_TYPES] = {
+    "sensory", "motor", "unipolar", "pseudounipolar", "bipolar", "multipolar"
+};
+
+enum DegreeDistribution { DEGREE_UNIFORM, DEGREE_POWERLAW };
+
+// -------------------------------
+// Generator Options
+// -------------------------------
+struct GenOptions {
+    long num_neurons, num_nerves;
+    double mean_degree;
+    enum DegreeDistribution distribution;
+    double alpha;
+    double locality, radius;
+    double bidirectional;
+    double weight_min, weight_max;
+    double max_value_min, max_value_max;
+    uint64_t seed;
+    const char *output;
+};
+
+static struct GenOptions opts = {
+    .num_neurons = 1000, .num_nerves = 100,
+    .mean_degree = 20.0,
+    .distribution = DEGREE_UNIFORM, .alpha = 2.1,
+    .locality = 0.0, .radius = 0.1,
+    .bidirectional = 0.75,
+    .weight_min = 0.0, .weight_max = 2.0,
+    .max_value_min = 1.0, .max_value_max = 100.0,
+    .seed = 1,
+    .output = NULL,
+};
+
+// -------------------------------
+// Deterministic RNG (xoshiro256**, seeded by splitmix64)
+// -------------------------------
+static uint64_t rng_state[4];
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t nextRandom() {
+    uint64_t result = rotl(rng_state[1] * 5, 7) * 9;
+    uint64_t t = rng_state[1] << 17;
+    rng_state[2] ^= rng_state[0];
+    rng_state[3] ^= rng_state[1];
+    rng_state[1] ^= rng_state[2];
+    rng_state[0] ^= rng_state[3];
+    rng_state[2] ^= t;
+    rng_state[3] = rotl(rng_state[3], 45);
+    return result;
+}
+
+static void seedRandom(uint64_t seed) {
+    for (int i = 0; i < 4; i++)
+        rng_state[i] = splitmix64(&seed);
+}
+
+// Uniform double in [0, 1)
+static double randomUnit() {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Uniform integer in [0, n)
+static long randomBelow(long n) {
+    return (long)(randomUnit() * (double)n);
+}
+
+static double randomRange(double lo, double hi) {
+    return lo + (hi - lo) * randomUnit();
+}
+
+// -------------------------------
+// Weighted node sampling via cumulative weights
+// -------------------------------
+static double *cumulative = NULL;
+
+static long sampleWeighted(long n) {
+    double r = randomUnit() * cumulative[n - 1];
+    long lo = 0, hi = n - 1;
+    while (lo < hi) {
+        long mid = lo + (hi - lo) / 2;
+        if (cumulative[mid] > r) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+// -------------------------------
+// Spatial grid for local targets
+// -------------------------------
+static float *pos_x, *pos_y, *pos_z;
+static int grid_dim = 1;
+static long *cell_start = NULL;   // grid_dim^3 + 1 offsets into cell_nodes
+static long *cell_nodes = NULL;
+
+static int cellCoord(float v) {
+    int c = (int)(v * grid_dim);
+    if (c < 0) c = 0;
+    if (c >= grid_dim) c = grid_dim - 1;
+    return c;
+}
+
+static long cellIndex(int cx, int cy, int cz) {
+    return ((long)cz * grid_dim + cy) * grid_dim + cx;
+}
+
+static void buildGrid(long n) {
+    grid_dim = (int)ceil(1.0 / opts.radius);
+    if (grid_dim < 1) grid_dim = 1;
+    long num_cells = (long)grid_dim * grid_dim * grid_dim;
+
+    cell_start = calloc(num_cells + 1, sizeof(long));
+    cell_nodes = malloc(n * sizeof(long));
+    long *fill = calloc(num_cells, sizeof(long));
+    if (!cell_start || !cell_nodes || !fill) {
+        fprintf(stderr, "Failed to allocate spatial grid (%ld cells)\n", num_cells);
+        exit(EXIT_FAILURE);
+    }
+
+    for (long i = 0; i < n; i++)
+        cell_start[cellIndex(cellCoord(pos_x[i]), cellCoord(pos_y[i]), cellCoord(pos_z[i])) + 1]++;
+    for (long c = 0; c < num_cells; c++)
+        cell_start[c + 1] += cell_start[c];
+    for (long i = 0; i < n; i++) {
+        long c = cellIndex(cellCoord(pos_x[i]), cellCoord(pos_y[i]), cellCoord(pos_z[i]));
+        cell_nodes[cell_start[c] + fill[c]++] = i;
+    }
+
+    free(fill);
+}
+
+// Random node in the source's cell or one of its 26 neighbours, or -1
+static long sampleLocal(long src) {
+    int cx = cellCoord(pos_x[src]), cy = cellCoord(pos_y[src]), cz = cellCoord(pos_z[src]);
+
+    for (int attempt = 0; attempt < LOCAL_TARGET_ATTEMPTS; attempt++) {
+        int nx = cx + (int)randomBelow(3) - 1;
+        int ny = cy + (int)randomBelow(3) - 1;
+        int nz = cz + (int)randomBelow(3) - 1;
+        if (nx < 0 || ny < 0 || nz < 0 || nx >= grid_dim || ny >= grid_dim || nz >= grid_dim)
+            continue;
+
+        long c = cellIndex(nx, ny, nz);
+        long count = cell_start[c + 1] - cell_start[c];
+        if (count == 0)
+            continue;
+
+        long tgt = cell_nodes[cell_start[c] + randomBelow(count)];
+        if (tgt != src)
+            return tgt;
+    }
+    return -1;
+}
+
+// -------------------------------
+// Usage and option parsing
+// -------------------------------
+static void printUsage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  --neurons <n>              Number of neurons (default %ld)\n", opts.num_neurons);
+    fprintf(stderr, "  --nerves <n>               Number of nerves (default %ld)\n", opts.num_nerves);
+    fprintf(stderr, "  --degree <d>               Mean edges per node (default %.1f)\n", opts.mean_degree);
+    fprintf(stderr, "  --distribution <name>      uniform or powerlaw (hub-heavy) degrees\n");
+    fprintf(stderr, "  --alpha <a>                Power-law exponent, > 1 (default %.1f)\n", opts.alpha);
+    fprintf(stderr, "  --locality <f>             Fraction of edges to spatial neighbours (default %.2f)\n", opts.locality);
+    fprintf(stderr, "  --radius <r>               Neighbourhood size in x/y/z units (default %.2f)\n", opts.radius);
+    fprintf(stderr, "  --bidirectional <f>        Fraction of bidirectional edges (default %.2f)\n", opts.bidirectional);
+    fprintf(stderr, "  --weights <min> <max>      Range of per-type weightings (default %.2f %.2f)\n", opts.weight_min, opts.weight_max);
+    fprintf(stderr, "  --max-values <min> <max>   Range of edge max_value (default %.2f %.2f)\n", opts.max_value_min, opts.max_value_max);
+    fprintf(stderr, "  --seed <s>                 RNG seed (default %llu)\n", (unsigned long long)opts.seed);
+    fprintf(stderr, "  -o <file>                  Output file (default stdout)\n");
+}
+
+static int parseArgs(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i];
+        int left = argc - i - 1;
+
+        if (strcmp(opt, "--neurons") == 0 && left >= 1) opts.num_neurons = atol(argv[++i]);
+        else if (strcmp(opt, "--nerves") == 0 && left >= 1) opts.num_nerves = atol(argv[++i]);
+        else if (strcmp(opt, "--degree") == 0 && left >= 1) opts.mean_degree = atof(argv[++i]);
+        else if (strcmp(opt, "--distribution") == 0 && left >= 1) {
+            const char *val = argv[++i];
+            if (strcmp(val, "uniform") == 0) opts.distribution = DEGREE_UNIFORM;
+            else if (strcmp(val, "powerlaw") == 0) opts.distribution = DEGREE_POWERLAW;
+            else {
+                fprintf(stderr, "Unknown degree distribution: %s\n", val);
+                return -1;
+            }
+        }
+        else if (strcmp(opt, "--alpha") == 0 && left >= 1) opts.alpha = atof(argv[++i]);
+        else if (strcmp(opt, "--locality") == 0 && left >= 1) opts.locality = atof(argv[++i]);
+        else if (strcmp(opt, "--radius") == 0 && left >= 1) opts.radius = atof(argv[++i]);
+        else if (strcmp(opt, "--bidirectional") == 0 && left >= 1) opts.bidirectional = atof(argv[++i]);
+        else if (strcmp(opt, "--weights") == 0 && left >= 2) {
+            opts.weight_min = atof(argv[++i]);
+            opts.weight_max = atof(argv[++i]);
+        }
+        else if (strcmp(opt, "--max-values") == 0 && left >= 2) {
+            opts.max_value_min = atof(argv[++i]);
+            opts.max_value_max = atof(argv[++i]);
+        }
+        else if (strcmp(opt, "--seed") == 0 && left >= 1) opts.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(opt, "-o") == 0 && left >= 1) opts.output = argv[++i];
+        else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", opt);
+            return -1;
+        }
+    }
+
+    if (opts.num_neurons < 0 || opts.num_nerves < 0 || opts.num_neurons + opts.num_nerves < 2) {
+        fprintf(stderr, "Need at least two nodes in total\n");
+        return -1;
+    }
+    if (opts.mean_degree <= 0 || opts.alpha <= 1.0 || opts.radius <= 0 ||
+        opts.locality < 0 || opts.locality > 1 || opts.bidirectional < 0 || opts.bidirectional > 1 ||
+        opts.weight_min > opts.weight_max || opts.max_value_min > opts.max_value_max) {
+        fprintf(stderr, "Option out of range\n");
+        return -1;
+    }
+    return 0;
+}
+
+// -------------------------------
+// Entry point
+// -------------------------------
+int main(int argc, char **argv) {
+    if (parseArgs(argc, argv) != 0) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = opts.output ? fopen(opts.output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Could not open output file %s\n", opts.output);
+        return EXIT_FAILURE;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    seedRandom(opts.seed);
+
+    long n = opts.num_neurons + opts.num_nerves;
+    long num_edges = (long)llround(opts.mean_degree * (double)n);
+
+    pos_x = malloc(n * sizeof(float));
+    pos_y = malloc(n * sizeof(float));
+    pos_z = malloc(n * sizeof(float));
+    cumulative = malloc(n * sizeof(double));
+    if (!pos_x || !pos_y || !pos_z || !cumulative) {
+        fprintf(stderr, "Failed to allocate node arrays for %ld nodes\n", n);
+        return EXIT_FAILURE;
+    }
+
+    // --- Header ---
+    fprintf(out, "<num_neurons>%ld</num_neurons>\n", opts.num_neurons);
+    fprintf(out, "<num_nerves>%ld</num_nerves>\n", opts.num_nerves);
+    fprintf(out, "<num_edges>%ld</num_edges>\n", num_edges);
+
+    // --- Nodes: neurons take IDs 0..N-1, nerves follow. Positions are
+    //     rounded to the two decimals written, so locality matches the file ---
+    double total_weight = 0.0;
+    for (long i = 0; i < n; i++) {
+        pos_x[i] = (float)(randomBelow(100) / 100.0);
+        pos_y[i] = (float)(randomBelow(100) / 100.0);
+        pos_z[i] = (float)(randomBelow(100) / 100.0);
+
+        if (i < opts.num_neurons) {
+            fprintf(out, "<neuron>\n    <id>%ld</id>\n    <x>%.2f</x>\n    <y>%.2f</y>\n    <z>%.2f</z>\n    <type>%s</type>\n</neuron>\n",
+                    i, pos_x[i], pos_y[i], pos_z[i], NEURON_TYPE_NAMES[randomBelow(NUM_NEURON_TYPES)]);
+        } else {
+            fprintf(out, "<nerve>\n    <id>%ld</id>\n</nerve>\n", i);
+        }
+
+        // Pareto-distributed node weights give a few high-degree hubs
+        double w = 1.0;
+        if (opts.distribution == DEGREE_POWERLAW)
+            w = pow(1.0 - randomUnit(), -1.0 / (opts.alpha - 1.0));
+        total_weight += w;
+        cumulative[i] = total_weight;
+    }
+
+    if (opts.locality > 0)
+        buildGrid(n);
+
+    // --- Edges: source by node weight, target local or by node weight ---
+    for (long e = 0; e < num_edges; e++) {
+        long src = sampleWeighted(n);
+        long tgt = -1;
+
+        if (opts.locality > 0 && randomUnit() < opts.locality)
+            tgt = sampleLocal(src);
+        while (tgt < 0 || tgt == src)
+            tgt = sampleWeighted(n);
+
+        fprintf(out, "<edge>\n    <from>%ld</from>\n    <to>%ld</to>\n    <direction>%s</direction>\n",
+                src, tgt, randomUnit() < opts.bidirectional ? "bidirectional" : "unidirectional");
+        for (int t = 0; t < NUM_SIGNAL_TYPES; t++)
+            fprintf(out, "    <weighting_%d>%.2f</weighting_%d>\n", t, randomRange(opts.weight_min, opts.weight_max), t);
+        fprintf(out, "    <max_value>%.2f</max_value>\n</edge>\n", randomRange(opts.max_value_min, opts.max_value_max));
+    }
+
+    if (out != stdout)
+        fclose(out);
+
+    free(pos_x);
+    free(pos_y);
+    free(pos_z);
+    free(cumulative);
+    free(cell_start);
+    free(cell_nodes);
+    return EXIT_SUCCESS;
+}
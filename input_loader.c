@@ -6,175 +6,386 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "brain.h"
+#include <mpi.h>
 
 // -------------------------------
 // External Globals
 // -------------------------------
 extern int rank;
-extern int *id_to_index_map;
+
+// Node IDs sorted for lookup; IDs may be sparse and arbitrarily large,
+// so this costs memory per node rather than per possible ID
+struct NodeIdEntry {
+    int id;
+    int idx;
+};
+
+static struct NodeIdEntry *id_index = NULL;
+static int id_index_count = 0;
+
+static int compareNodeIds(const void *a, const void *b) {
+    int x = ((const struct NodeIdEntry *)a)->id, y = ((const struct NodeIdEntry *)b)->id;
+    return (x > y) - (x < y);
+}
 
 // -------------------------------
-// Load brain graph from file
+// Text graph parsing
 // -------------------------------
-void loadBrainGraph(char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "[Rank %d] Could not open file %s\n", rank, filename);
-        exit(EXIT_FAILURE);
+// The file is memory-mapped and cut into one chunk per thread at lines
+// that open a <neuron>, <nerve> or <edge> record, so no record spans two
+// chunks. A first parallel pass counts the records in each chunk; their
+// prefix sums give every chunk its first node and edge index, and a
+// second pass parses straight into the graph arena. Nodes and
+// edges keep file order whatever the thread count.
+
+#define MAX_LOADER_THREADS 16
+
+struct ParseChunk {
+    const char *begin, *end;
+    int num_nodes, num_edges;      // records opened in this chunk
+    int first_node, first_edge;    // global index of the first of each
+    struct NeuronNerveStruct *nodes;   // brain_nodes of the loading thread
+};
+
+// Locale-independent decimal parser. A mantissa of at most 2^53 (so
+// exactly representable as a double) with a small exponent takes one
+// correctly rounded multiply or divide by an exact power of ten, which
+// matches strtod. Anything else falls back to strtod. The file is mapped
+// without a terminator, so every scan stops at end
+#define MAX_NUMBER_TOKEN 64
+
+static const double POW10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static int isDigit(const char *p, const char *end) {
+    return p < end && *p >= '0' && *p <= '9';
+}
+
+// strtod on a NUL-terminated copy of the number starting at p
+static double parseDecimalSlow(const char *p, const char *end) {
+    char token[MAX_NUMBER_TOKEN];
+    size_t len = 0;
+    while (p < end && len + 1 < sizeof(token) &&
+           ((*p >= '0' && *p <= '9') || *p == '.' || *p == '-' || *p == '+' || *p == 'e' || *p == 'E'))
+        token[len++] = *p++;
+    token[len] = '\0';
+    return strtod(token, NULL);
+}
+
+static double parseDecimal(const char *p, const char *end) {
+    const char *start = p;
+    int negative = 0;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    for (; isDigit(p, end); p++, digits++)
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    if (p < end && *p == '.') {
+        for (p++; isDigit(p, end); p++, digits++, exponent--)
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        int exp_negative = 0, exp_value = 0;
+        if (q < end && (*q == '-' || *q == '+'))
+            exp_negative = (*q++ == '-');
+        if (!isDigit(q, end))
+            return parseDecimalSlow(start, end);
+        for (; isDigit(q, end) && exp_value < 10000; q++)
+            exp_value = exp_value * 10 + (*q - '0');
+        exponent += exp_negative ? -exp_value : exp_value;
     }
 
-    const char whitespace[] = " \f\n\r\t\v";
-    enum ReadMode currentMode = NONE;
-    char buffer[MAX_LINE_LEN];
-    int node_capacity = 128;
-    int edge_capacity = 256;
+    if (digits > 19 || mantissa > (1ULL << 53) || exponent < -22 || exponent > 22)
+        return parseDecimalSlow(start, end);
 
-    brain_nodes = calloc(node_capacity, sizeof(struct NeuronNerveStruct));
-    edges = calloc(edge_capacity, sizeof(struct EdgeStruct));
-    if (!brain_nodes || !edges) {
-        fprintf(stderr, "[Rank %d]Memory allocation failed\n", rank);
-        exit(EXIT_FAILURE);
+    double value = (double)mantissa;
+    value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+    return negative ? -value : value;
+}
+
+static int parseInteger(const char *p, const char *end) {
+    int negative = 0, value = 0;
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+    for (; isDigit(p, end); p++)
+        value = value * 10 + (*p - '0');
+    return negative ? -value : value;
+}
+
+static const char *skipSpace(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\f' || *p == '\v'))
+        p++;
+    return p;
+}
+
+static const char *nextLine(const char *p, const char *end) {
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return newline ? newline + 1 : end;
+}
+
+static int hasPrefix(const char *p, const char *end, const char *prefix, size_t len) {
+    return (size_t)(end - p) >= len && memcmp(p, prefix, len) == 0;
+}
+
+// 1 for <neuron>, 2 for <nerve>, 3 for <edge>, else 0
+static int recordOpener(const char *line, const char *end) {
+    const char *p = skipSpace(line, end);
+    if (p >= end || *p != '<')
+        return 0;
+    if (hasPrefix(p, end, "<neuron>", 8)) return 1;
+    if (hasPrefix(p, end, "<nerve>", 7)) return 2;
+    if (hasPrefix(p, end, "<edge>", 6)) return 3;
+    return 0;
+}
+
+// First line at or after p that opens a record
+static const char *nextRecord(const char *p, const char *begin, const char *end) {
+    if (p > begin && p[-1] != '\n')
+        p = nextLine(p, end);
+    while (p < end && !recordOpener(p, end))
+        p = nextLine(p, end);
+    return p;
+}
+
+static void *countRecords(void *arg) {
+    struct ParseChunk *chunk = arg;
+    chunk->num_nodes = chunk->num_edges = 0;
+    for (const char *line = chunk->begin; line < chunk->end; line = nextLine(line, chunk->end)) {
+        int kind = recordOpener(line, chunk->end);
+        if (kind == 1 || kind == 2) chunk->num_nodes++;
+        else if (kind == 3) chunk->num_edges++;
     }
+    return NULL;
+}
 
-    // Initialize ID-to-index map
-    for (int i = 0; i < MAX_NODE_ID; i++) {
-        id_to_index_map[i] = -1;
+static void parseNeuronType(struct NeuronNerveStruct *node, const char *type, const char *end) {
+    if (hasPrefix(type, end, "sensory", 7)) node->neuron_type = SENSORY;
+    else if (hasPrefix(type, end, "motor", 5)) node->neuron_type = MOTOR;
+    else if (hasPrefix(type, end, "unipolar", 8)) node->neuron_type = UNIPOLAR;
+    else if (hasPrefix(type, end, "pseudounipolar", 14)) node->neuron_type = PSEUDOUNIPOLAR;
+    else if (hasPrefix(type, end, "bipolar", 7)) node->neuron_type = BIPOLAR;
+    else if (hasPrefix(type, end, "multipolar", 10)) node->neuron_type = MULTIPOLAR;
+    else {
+        int len = 0;
+        while (type + len < end && type[len] != '<' && type[len] != '\n') len++;
+        fprintf(stderr, "[Rank %d] Unknown neuron type: %.*s\n", rank, len, type);
+        exit(EXIT_FAILURE);
     }
+}
 
-    int currentNeuronIdx = 0;
-    int currentEdgeIdx = 0;
+static void *parseRecords(void *arg) {
+    struct ParseChunk *chunk = arg;
+    enum ReadMode mode = NONE;
+    struct NeuronNerveStruct *node = NULL;
+    struct EdgeStruct *edge = NULL;
+    int node_idx = chunk->first_node, edge_idx = chunk->first_edge;
+    const char *end = chunk->end;
+
+    for (const char *line = chunk->begin; line < end; line = nextLine(line, end)) {
+        if (*line == '%')
+            continue;
+        const char *p = skipSpace(line, end);
+        if (p + 2 >= end || *p != '<')
+            continue;
+        const char *value = memchr(p, '>', (size_t)(end - p));
+        if (!value)
+            continue;
+        value++;
+
+        // Dispatch on the first character of the tag name
+        switch (p[1]) {
+            case 'n':
+                if (hasPrefix(p, end, "<neuron>", 8) || hasPrefix(p, end, "<nerve>", 7)) {
+                    mode = NEURON_NERVE;
+                    node = &chunk->nodes[node_idx];
+                    node->node_type = (p[2] == 'e' && p[3] == 'u') ? NEURON : NERVE;
+                    node_idx++;
+                }
+                break;
 
-    // -------------------------------
-    // File Parsing
-    // -------------------------------
-    while (fgets(buffer, MAX_LINE_LEN, file)) {
-        if (buffer[0] == '%') continue;
-        char *line_contents = buffer + strspn(buffer, whitespace);
-
-        // --- Begin neuron or nerve node ---
-        if (strncmp("<neuron>", line_contents, 8) == 0 || strncmp("<nerve>", line_contents, 7) == 0) {
-            currentMode = NEURON_NERVE;
-
-            if (currentNeuronIdx >= node_capacity) {
-                node_capacity *= 2;
-                brain_nodes = realloc(brain_nodes, node_capacity * sizeof(struct NeuronNerveStruct));
-                if (!brain_nodes) {
-                    fprintf(stderr, "[Rank %d] realloc failed for brain_nodes\n", rank);
-                    exit(EXIT_FAILURE);
+            case 'e':
+                if (hasPrefix(p, end, "<edge>", 6)) {
+                    mode = EDGE;
+                    edge = &edges[edge_idx];
+                    edge_idx++;
+                }
+                break;
+
+            case '/':
+                if (hasPrefix(p, end, "</neuron>", 9) || hasPrefix(p, end, "</nerve>", 8) ||
+                    hasPrefix(p, end, "</edge>", 7))
+                    mode = NONE;
+                break;
+
+            case 'i':
+                if (mode == NEURON_NERVE && hasPrefix(p, end, "<id>", 4))
+                    node->id = parseInteger(value, end);
+                break;
+
+            case 'x': case 'y': case 'z':
+                if (mode == NEURON_NERVE && p[2] == '>') {
+                    float coord = (float)parseDecimal(value, end);
+                    if (p[1] == 'x') node->x = coord;
+                    else if (p[1] == 'y') node->y = coord;
+                    else node->z = coord;
                 }
-            }
-
-            struct NeuronNerveStruct *node = &brain_nodes[currentNeuronIdx];
-            memset(node, 0, sizeof(struct NeuronNerveStruct));
-
-            node->signalInbox = calloc(SIGNAL_INBOX_SIZE, sizeof(struct SignalStruct));
-            node->num_nerve_inputs = calloc(NUM_SIGNAL_TYPES, sizeof(int));
-            node->num_nerve_outputs = calloc(NUM_SIGNAL_TYPES, sizeof(int));
-            if (!node->signalInbox || !node->num_nerve_inputs || !node->num_nerve_outputs) {
-                fprintf(stderr, "[Rank %d] Allocation failed for node[%d]\n", rank, currentNeuronIdx);
-                exit(EXIT_FAILURE);
-            }
-
-            node->node_type = (strncmp("<neuron>", line_contents, 8) == 0) ? NEURON : NERVE;
-
-        // --- End neuron or nerve node ---
-        } else if (strncmp("</neuron>", line_contents, 9) == 0 || strncmp("</nerve>", line_contents, 8) == 0) {
-            currentMode = NONE;
-            currentNeuronIdx++;
-
-        // --- Begin edge definition ---
-        } else if (strncmp("<edge>", line_contents, 6) == 0) {
-            currentMode = EDGE;
-
-            if (currentEdgeIdx >= edge_capacity) {
-                edge_capacity *= 2;
-                edges = realloc(edges, edge_capacity * sizeof(struct EdgeStruct));
-                if (!edges) {
-                    fprintf(stderr, "[Rank %d] realloc failed for edges\n", rank);
-                    exit(EXIT_FAILURE);
+                break;
+
+            case 't':
+                if (mode == NEURON_NERVE && hasPrefix(p, end, "<type>", 6)) {
+                    if (node->node_type == NEURON)
+                        parseNeuronType(node, value, end);
+                } else if (mode == EDGE && hasPrefix(p, end, "<to>", 4)) {
+                    edge->to = parseInteger(value, end);
                 }
-            }
-
-            edges[currentEdgeIdx].messageTypeWeightings = calloc(NUM_SIGNAL_TYPES, sizeof(float));
-            if (!edges[currentEdgeIdx].messageTypeWeightings) {
-                fprintf(stderr, "[Rank %d] Failed to allocate weightings for edge %d\n", rank, currentEdgeIdx);
-                exit(EXIT_FAILURE);
-            }
-
-        // --- End edge definition ---
-        } else if (strncmp("</edge>", line_contents, 7) == 0 && currentMode == EDGE) {
-            currentMode = NONE;
-            currentEdgeIdx++;
-
-        // --- Node properties ---
-        } else if (strncmp("<id>", line_contents, 4) == 0 && currentMode == NEURON_NERVE) {
-            int id = atoi(strstr(line_contents, ">") + 1);
-            brain_nodes[currentNeuronIdx].id = id;
-
-            if (id >= MAX_NODE_ID) {
-                fprintf(stderr, "[Rank %d] Node ID %d exceeds max supported (%d)\n", rank, id, MAX_NODE_ID);
-                exit(EXIT_FAILURE);
-            }
-
-            id_to_index_map[id] = currentNeuronIdx;
-
-        } else if (strncmp("<x>", line_contents, 3) == 0) {
-            brain_nodes[currentNeuronIdx].x = atof(strstr(line_contents, ">") + 1);
-
-        } else if (strncmp("<y>", line_contents, 3) == 0) {
-            brain_nodes[currentNeuronIdx].y = atof(strstr(line_contents, ">") + 1);
-
-        } else if (strncmp("<z>", line_contents, 3) == 0) {
-            brain_nodes[currentNeuronIdx].z = atof(strstr(line_contents, ">") + 1);
-
-        } else if (strncmp("<type>", line_contents, 6) == 0) {
-            if (brain_nodes[currentNeuronIdx].node_type == NEURON) {
-                char *type = strstr(line_contents, ">") + 1;
-                if (strncmp(type, "sensory", 7) == 0) brain_nodes[currentNeuronIdx].neuron_type = SENSORY;
-                else if (strncmp(type, "motor", 5) == 0) brain_nodes[currentNeuronIdx].neuron_type = MOTOR;
-                else if (strncmp(type, "unipolar", 8) == 0) brain_nodes[currentNeuronIdx].neuron_type = UNIPOLAR;
-                else if (strncmp(type, "pseudounipolar", 14) == 0) brain_nodes[currentNeuronIdx].neuron_type = PSEUDOUNIPOLAR;
-                else if (strncmp(type, "bipolar", 7) == 0) brain_nodes[currentNeuronIdx].neuron_type = BIPOLAR;
-                else if (strncmp(type, "multipolar", 10) == 0) brain_nodes[currentNeuronIdx].neuron_type = MULTIPOLAR;
-                else {
-                    fprintf(stderr, "[Rank %d] Unknown neuron type: %s\n", rank, type);
-                    exit(EXIT_FAILURE);
+                break;
+
+            case 'f':
+                if (mode == EDGE && hasPrefix(p, end, "<from>", 6))
+                    edge->from = parseInteger(value, end);
+                break;
+
+            case 'd':
+                if (mode == EDGE && hasPrefix(p, end, "<direction>", 11))
+                    edge->direction = hasPrefix(value, end, "bidirectional", 13) ? BIDIRECTIONAL : UNIDIRECTIONAL;
+                break;
+
+            case 'm':
+                if (mode == EDGE && hasPrefix(p, end, "<max_value>", 11))
+                    edge->max_value = (float)parseDecimal(value, end);
+                break;
+
+            case 'w':
+                if (mode == EDGE && hasPrefix(p, end, "<weighting_", 11)) {
+                    int idx = parseInteger(p + 11, end);
+                    if (idx >= 0 && idx < NUM_SIGNAL_TYPES)
+                        edge->messageTypeWeightings[idx] = (float)parseDecimal(value, end);
+                    else
+                        fprintf(stderr, "[Rank %d] Invalid signal weighting index: %d\n", rank, idx);
                 }
-            }
-
-        // --- Edge properties ---
-        } else if (strncmp("<from>", line_contents, 6) == 0 && currentMode == EDGE) {
-            edges[currentEdgeIdx].from = atoi(strstr(line_contents, ">") + 1);
-
-        } else if (strncmp("<to>", line_contents, 4) == 0 && currentMode == EDGE) {
-            edges[currentEdgeIdx].to = atoi(strstr(line_contents, ">") + 1);
-
-        } else if (strncmp("<direction>", line_contents, 11) == 0 && currentMode == EDGE) {
-            char *dir = strstr(line_contents, ">") + 1;
-            if (strstr(dir, "bidirectional")) edges[currentEdgeIdx].direction = BIDIRECTIONAL;
-            else edges[currentEdgeIdx].direction = UNIDIRECTIONAL;
-
-        } else if (strncmp("<max_value>", line_contents, 11) == 0 && currentMode == EDGE) {
-            edges[currentEdgeIdx].max_value = atof(strstr(line_contents, ">") + 1);
-
-        } else if (strncmp("<weighting_", line_contents, 11) == 0 && currentMode == EDGE) {
-            int idx = atoi(&line_contents[11]);
-            if (idx >= 0 && idx < NUM_SIGNAL_TYPES) {
-                edges[currentEdgeIdx].messageTypeWeightings[idx] = atof(strstr(line_contents, ">") + 1);
-            } else {
-                fprintf(stderr, "[Rank %d] Invalid signal weighting index: %d\n", rank, idx);
-            }
+                break;
         }
     }
+    return NULL;
+}
+
+// Value of a <tag>n</tag> header line before the first record, or -1
+static int headerCount(const char *begin, const char *end, const char *tag) {
+    size_t len = strlen(tag);
+    for (const char *line = begin; line < end && !recordOpener(line, end); line = nextLine(line, end)) {
+        const char *p = skipSpace(line, end);
+        if (hasPrefix(p, end, tag, len))
+            return parseInteger(p + len, end);
+    }
+    return -1;
+}
+
+static int loaderThreadCount(size_t bytes) {
+    int threads = sim_options.loader_threads;
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    // Below a few hundred KB per thread the thread start-up dominates
+    int by_size = (int)(bytes / (256 * 1024)) + 1;
+    if (threads > by_size) threads = by_size;
+    if (threads > MAX_LOADER_THREADS) threads = MAX_LOADER_THREADS;
+    return threads;
+}
+
+// Run fn over every chunk, one thread each; chunk 0 on the calling thread
+static void runChunks(void *(*fn)(void *), struct ParseChunk *chunks, int count) {
+    pthread_t threads[MAX_LOADER_THREADS];
+    int started[MAX_LOADER_THREADS] = { 0 };
+    for (int t = 1; t < count; t++)
+        started[t] = (pthread_create(&threads[t], NULL, fn, &chunks[t]) == 0);
+    fn(&chunks[0]);
+    for (int t = 1; t < count; t++) {
+        if (started[t]) pthread_join(threads[t], NULL);
+        else fn(&chunks[t]);
+    }
+}
+
+// -------------------------------
+// Load brain graph from file
+// -------------------------------
+void loadBrainGraph(char *filename) {
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "[Rank %d] Could not open file %s\n", rank, filename);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t bytes = (size_t)st.st_size;
+    const char *text = bytes ? mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    if (bytes && text == MAP_FAILED) {
+        fprintf(stderr, "[Rank %d] Could not map file %s\n", rank, filename);
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    if (bytes)
+        madvise((void *)text, bytes, MADV_SEQUENTIAL);
+    const char *end = text + bytes;
+
+    // --- Split at record boundaries ---
+    int count = loaderThreadCount(bytes);
+    struct ParseChunk chunks[MAX_LOADER_THREADS];
+    const char *first = nextRecord(text, text, end);
+    for (int t = 0; t < count; t++) {
+        const char *cut = first + (size_t)(end - first) * t / count;
+        chunks[t].begin = t == 0 ? first : nextRecord(cut, text, end);
+    }
+    for (int t = 0; t < count; t++)
+        chunks[t].end = t + 1 < count ? chunks[t + 1].begin : end;
 
-    fclose(file);
+    runChunks(countRecords, chunks, count);
+
+    int total_nodes = 0, total_edges = 0;
+    for (int t = 0; t < count; t++) {
+        chunks[t].first_node = total_nodes;
+        chunks[t].first_edge = total_edges;
+        total_nodes += chunks[t].num_nodes;
+        total_edges += chunks[t].num_edges;
+    }
+
+    int header_nodes = headerCount(text, first, "<num_neurons>");
+    int header_nerves = headerCount(text, first, "<num_nerves>");
+    int header_edges = headerCount(text, first, "<num_edges>");
+    if (header_nodes >= 0 && header_nerves >= 0 && header_edges >= 0 &&
+        (header_nodes + header_nerves != total_nodes || header_edges != total_edges)) {
+        fprintf(stderr, "[Rank %d] Header of %s declares %d nodes and %d edges, file has %d and %d\n",
+                rank, filename, header_nodes + header_nerves, header_edges, total_nodes, total_edges);
+    }
+
+    // Records are zeroed with their buffers in place; the parse only
+    // fills in fields
+    allocateGraph(total_nodes, total_edges);
+
+    for (int t = 0; t < count; t++)
+        chunks[t].nodes = brain_nodes;
+    runChunks(parseRecords, chunks, count);
+    if (bytes)
+        munmap((void *)text, bytes);
 
     // -------------------------------
     // Post-processing and Summary
     // -------------------------------
-    num_brain_nodes = currentNeuronIdx;
-    num_edges = currentEdgeIdx;
+    num_brain_nodes = total_nodes;
+    num_edges = total_edges;
     num_neurons = 0;
     num_nerves = 0;
 
@@ -183,43 +394,92 @@ void loadBrainGraph(char *filename) {
         else if (brain_nodes[i].node_type == NERVE) num_nerves++;
     }
 
+    // Resolve edge endpoints to dense indices once, so the hot path never
+    // looks up IDs
+    buildNodeIdIndex();
+    for (int j = 0; j < num_edges; j++) {
+        edges[j].from_idx = getNodeIndexById(edges[j].from);
+        edges[j].to_idx = getNodeIndexById(edges[j].to);
+        if (edges[j].from_idx == -1 || edges[j].to_idx == -1)
+            fprintf(stderr, "[Rank %d] Edge %d references unknown node (%d -> %d)\n",
+                    rank, j, edges[j].from, edges[j].to);
+    }
+
     if (rank == 0) {
-        printf("[Rank 0] Loaded %d neurons, %d nerves, %d total nodes, %d edges\n",
-               num_neurons, num_nerves, num_brain_nodes, num_edges);
+        printf("[Rank 0] Loaded %d neurons, %d nerves, %d total nodes, %d edges (%d parser threads)\n",
+               num_neurons, num_nerves, num_brain_nodes, num_edges, count);
     }
 }
 
 // -------------------------------
-// Link nodes to their edges
+// Build the sorted ID index over brain_nodes. Duplicate IDs are fatal
+// since signals could not be routed unambiguously
 // -------------------------------
-void linkNodesToEdges() {
-    for (int i = 0; i < num_brain_nodes; i++) {
-        int id = brain_nodes[i].id;
-        int edge_count = 0;
+void buildNodeIdIndex() {
+    freeNodeIdIndex();
+    id_index = malloc((num_brain_nodes ? num_brain_nodes : 1) * sizeof(struct NodeIdEntry));
+    if (!id_index) {
+        fprintf(stderr, "[Rank %d] Failed to allocate node ID index\n", rank);
+        exit(EXIT_FAILURE);
+    }
 
-        for (int j = 0; j < num_edges; j++) {
-            if (edges[j].from == id || edges[j].to == id) {
-                edge_count++;
-            }
-        }
+    for (int i = 0; i < num_brain_nodes; i++) {
+        id_index[i].id = brain_nodes[i].id;
+        id_index[i].idx = i;
+    }
+    id_index_count = num_brain_nodes;
+    qsort(id_index, id_index_count, sizeof(struct NodeIdEntry), compareNodeIds);
 
-        brain_nodes[i].num_edges = edge_count;
-        brain_nodes[i].edges = malloc(edge_count * sizeof(int));
-        if (!brain_nodes[i].edges) {
-            fprintf(stderr, "[Rank %d] Failed to allocate edges for node ID %d\n", rank, id);
+    for (int i = 1; i < id_index_count; i++) {
+        if (id_index[i].id == id_index[i - 1].id) {
+            fprintf(stderr, "[Rank %d] Duplicate node ID %d\n", rank, id_index[i].id);
             exit(EXIT_FAILURE);
         }
+    }
+}
 
-        int count = 0;
-        for (int j = 0; j < num_edges; j++) {
-            if (edges[j].from == id || edges[j].to == id) {
-                brain_nodes[i].edges[count++] = j;
-            }
-        }
+// -------------------------------
+// Map a node ID to its dense index, or -1 if unknown
+// -------------------------------
+int getNodeIndexById(int id) {
+    int lo = 0, hi = id_index_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (id_index[mid].id == id) return id_index[mid].idx;
+        if (id_index[mid].id < id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
 
-        if (count != edge_count) {
-            fprintf(stderr, "[Rank %d]️ Edge mismatch for node ID %d: expected %d, got %d\n", rank, id, edge_count, count);
-        }
+void freeNodeIdIndex() {
+    free(id_index);
+    id_index = NULL;
+    id_index_count = 0;
+}
+
+// -------------------------------
+// Link nodes to their edges. Every list entry is a valid index into
+// edges[]; the specialised kernels rely on it and do not check
+// -------------------------------
+void linkNodesToEdges() {
+    for (int i = 0; i < num_brain_nodes; i++)
+        brain_nodes[i].num_edges = 0;
+
+    for (int j = 0; j < num_edges; j++) {
+        if (edges[j].from_idx != -1) brain_nodes[edges[j].from_idx].num_edges++;
+        if (edges[j].to_idx != -1 && edges[j].to_idx != edges[j].from_idx) brain_nodes[edges[j].to_idx].num_edges++;
+    }
+
+    allocateEdgeLists();
+    for (int i = 0; i < num_brain_nodes; i++)
+        brain_nodes[i].num_edges = 0;
+
+    // Fill in edge order so each node's list matches the file order
+    for (int j = 0; j < num_edges; j++) {
+        int from = edges[j].from_idx, to = edges[j].to_idx;
+        if (from != -1) brain_nodes[from].edges[brain_nodes[from].num_edges++] = j;
+        if (to != -1 && to != from) brain_nodes[to].edges[brain_nodes[to].num_edges++] = j;
     }
 }
 
@@ -240,3 +500,87 @@ int neuronTypeToIndex(enum NeuronType type) {
     }
 }
 
+
+// -------------------------------
+// Replicate edges and per-node edge lists from rank 0, so whichever rank
+// owns a node (now or after rebalancing) can fire it
+// -------------------------------
+#define EDGE_INT_FIELDS 5
+#define EDGE_FLOAT_FIELDS (1 + NUM_SIGNAL_TYPES)
+
+void broadcastEdges() {
+    int *ints = malloc((size_t)(num_edges ? num_edges : 1) * EDGE_INT_FIELDS * sizeof(int));
+    float *floats = malloc((size_t)(num_edges ? num_edges : 1) * EDGE_FLOAT_FIELDS * sizeof(float));
+    int *edge_counts = malloc((size_t)(num_brain_nodes ? num_brain_nodes : 1) * sizeof(int));
+    if (!ints || !floats || !edge_counts) {
+        fprintf(stderr, "[Rank %d] Failed to allocate edge broadcast buffers\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (rank == 0) {
+        for (int j = 0; j < num_edges; j++) {
+            int *ip = &ints[j * EDGE_INT_FIELDS];
+            float *fp = &floats[j * EDGE_FLOAT_FIELDS];
+            ip[0] = edges[j].from;
+            ip[1] = edges[j].to;
+            ip[2] = edges[j].from_idx;
+            ip[3] = edges[j].to_idx;
+            ip[4] = edges[j].direction;
+            fp[0] = edges[j].max_value;
+            memcpy(fp + 1, edges[j].messageTypeWeightings, NUM_SIGNAL_TYPES * sizeof(float));
+        }
+        for (int i = 0; i < num_brain_nodes; i++)
+            edge_counts[i] = brain_nodes[i].num_edges;
+    }
+
+    MPI_Bcast(ints, num_edges * EDGE_INT_FIELDS, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(floats, num_edges * EDGE_FLOAT_FIELDS, MPI_FLOAT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(edge_counts, num_brain_nodes, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // Per-node edge lists, concatenated in node order
+    long long total_links = 0;
+    for (int i = 0; i < num_brain_nodes; i++)
+        total_links += edge_counts[i];
+    int *links = malloc((size_t)(total_links ? total_links : 1) * sizeof(int));
+    if (!links) {
+        fprintf(stderr, "[Rank %d] Failed to allocate edge lists\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (rank == 0) {
+        long long pos = 0;
+        for (int i = 0; i < num_brain_nodes; i++) {
+            memcpy(&links[pos], brain_nodes[i].edges, edge_counts[i] * sizeof(int));
+            pos += edge_counts[i];
+        }
+    }
+    MPI_Bcast(links, (int)total_links, MPI_INT, 0, MPI_COMM_WORLD);
+
+    if (rank != 0) {
+        for (int j = 0; j < num_edges; j++) {
+            int *ip = &ints[j * EDGE_INT_FIELDS];
+            float *fp = &floats[j * EDGE_FLOAT_FIELDS];
+            edges[j].from = ip[0];
+            edges[j].to = ip[1];
+            edges[j].from_idx = ip[2];
+            edges[j].to_idx = ip[3];
+            edges[j].direction = ip[4];
+            edges[j].max_value = fp[0];
+            memcpy(edges[j].messageTypeWeightings, fp + 1, NUM_SIGNAL_TYPES * sizeof(float));
+        }
+
+        for (int i = 0; i < num_brain_nodes; i++)
+            brain_nodes[i].num_edges = edge_counts[i];
+        allocateEdgeLists();
+
+        long long pos = 0;
+        for (int i = 0; i < num_brain_nodes; i++) {
+            memcpy(brain_nodes[i].edges, &links[pos], edge_counts[i] * sizeof(int));
+            pos += edge_counts[i];
+        }
+    }
+
+    free(ints);
+    free(floats);
+    free(edge_counts);
+    free(links);
+}
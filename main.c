@@ -7,70 +7,63 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <unistd.h>
 
 // Global brain data
 struct NeuronNerveStruct *brain_nodes = NULL;
 struct EdgeStruct *edges = NULL;
 int num_neurons = 0, num_nerves = 0, num_edges = 0, num_brain_nodes = 0, elapsed_ns = 0;
 
-// Global ID mapping pointers
-int *id_to_index_map = NULL;
-int *id_to_index = NULL;
-
 // MPI globals
 int rank, size;
 
+static void runSimulation(int num_ns_to_simulate, const char *report_file, int *start_out, int *end_out);
+
 int main(int argc, char **argv) {
-    MPI_Init(&argc, &argv);
+    // Only the progress thread (--progress-thread) makes MPI calls
+    // alongside the main thread, so only it pays for MPI_THREAD_MULTIPLE;
+    // the telemetry writer and loader threads never call MPI. Options are
+    // looked at before MPI starts to pick the level: with no rank yet (-1)
+    // that pass prints nothing, and the pass below reports as usual
+    rank = -1;
+    if (argc >= 3)
+        parseOptions(argc, argv);
+    int required = sim_options.progress_thread ? MPI_THREAD_MULTIPLE : MPI_THREAD_FUNNELED;
+    int provided;
+    MPI_Init_thread(&argc, &argv, required, &provided);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
 
-    create_mpi_signal_type();
-
-    if (argc < 3) {
-        if (rank == 0)
-            fprintf(stderr, "Usage: %s <brain_graph_file> <num_nanoseconds>\n", argv[0]);
-        MPI_Type_free(&MPI_PackedSignal);
+    if (argc < 3 || parseOptions(argc, argv) != 0) {
+        printUsage(argv[0]);
         MPI_Finalize();
         return EXIT_FAILURE;
     }
 
-    srand((unsigned)(time(NULL) + rank));
-
-    id_to_index_map = malloc(sizeof(int) * MAX_NODE_ID);
-    if (!id_to_index_map) {
-        fprintf(stderr, "[Rank %d] Failed to allocate id_to_index_map\n", rank);
-        MPI_Abort(MPI_COMM_WORLD, 1);
+    if (sim_options.progress_thread && provided < MPI_THREAD_MULTIPLE) {
+        if (rank == 0)
+            fprintf(stderr, "[Rank %d] MPI library lacks MPI_THREAD_MULTIPLE, running without progress thread\n", rank);
+        sim_options.progress_thread = 0;
     }
 
+    // Before anything is allocated or any thread is started
+    if (sim_options.numa_bind)
+        bindToNumaNode();
+
+    initSignalExchange(size);
+
     if (rank == 0) {
         loadBrainGraph(argv[1]);
+        reorderNodes(sim_options.reorder);
         linkNodesToEdges();
     }
 
-    MPI_Bcast(id_to_index_map, MAX_NODE_ID, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&num_brain_nodes, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&num_neurons, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&num_nerves, 1, MPI_INT, 0, MPI_COMM_WORLD);
     MPI_Bcast(&num_edges, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-    id_to_index = malloc(sizeof(int) * MAX_NODE_ID);
-    if (!id_to_index) {
-        fprintf(stderr, "[Rank %d] Failed to allocate id_to_index\n", rank);
-        MPI_Abort(MPI_COMM_WORLD, 1);
-    }
-    memcpy(id_to_index, id_to_index_map, sizeof(int) * MAX_NODE_ID);
-    for (int i = 0; i < MAX_NODE_ID; i++)
-        id_to_index_map[i] = -1;
-
     if (rank != 0) {
-        brain_nodes = calloc(num_brain_nodes, sizeof(struct NeuronNerveStruct));
-        edges = calloc(1, sizeof(struct EdgeStruct)); // Dummy
-        if (!brain_nodes || !edges) {
-            fprintf(stderr, "[Rank %d] Allocation failure for brain_nodes or edges\n", rank);
-            MPI_Abort(MPI_COMM_WORLD, 1);
-        }
+        allocateGraph(num_brain_nodes, num_edges);
     }
 
     for (int i = 0; i < num_brain_nodes; i++) {
@@ -83,20 +76,18 @@ int main(int argc, char **argv) {
         MPI_Bcast(&brain_nodes[i].signals_last_ns, 1, MPI_INT, 0, MPI_COMM_WORLD);
         MPI_Bcast(&brain_nodes[i].signals_this_ns, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
-        brain_nodes[i].signalInbox = calloc(SIGNAL_INBOX_SIZE, sizeof(struct SignalStruct));
-        brain_nodes[i].num_nerve_inputs = calloc(NUM_SIGNAL_TYPES, sizeof(int));
-        brain_nodes[i].num_nerve_outputs = calloc(NUM_SIGNAL_TYPES, sizeof(int));
-        brain_nodes[i].num_outstanding_signals = 0;
-
-        if (!brain_nodes[i].signalInbox || !brain_nodes[i].num_nerve_inputs || !brain_nodes[i].num_nerve_outputs) {
-            fprintf(stderr, "[Rank %d] Allocation failure in brain_nodes[%d]\n", rank, i);
-            MPI_Abort(MPI_COMM_WORLD, 1);
-        }
-
         MPI_Bcast(brain_nodes[i].num_nerve_inputs, NUM_SIGNAL_TYPES, MPI_INT, 0, MPI_COMM_WORLD);
         MPI_Bcast(brain_nodes[i].num_nerve_outputs, NUM_SIGNAL_TYPES, MPI_INT, 0, MPI_COMM_WORLD);
     }
 
+    // Rank 0 built its ID index while loading
+    if (rank != 0)
+        buildNodeIdIndex();
+    broadcastEdges();
+    broadcastNodeOrder(sim_options.reorder);
+    if (sim_options.edge_format == EDGE_COMPACT)
+        buildCompactEdges();
+
     if (rank == 0 && (!brain_nodes || !edges || num_brain_nodes == 0 || num_edges == 0)) {
         fprintf(stderr, "[Rank 0] Invalid brain graph structure\n");
         MPI_Abort(MPI_COMM_WORLD, 1);
@@ -107,113 +98,268 @@ int main(int argc, char **argv) {
     fflush(stdout);
     MPI_Barrier(MPI_COMM_WORLD);
 
-    int neurons_per_rank = num_brain_nodes / size;
-    int remainder = num_brain_nodes % size;
-    int start_idx = rank * neurons_per_rank + (rank < remainder ? rank : remainder);
-    int local_count = neurons_per_rank + (rank < remainder ? 1 : 0);
-    int end_idx = start_idx + local_count;
-
-    printf("[Rank %d] Handling brain nodes from %d to %d (count = %d)\n",
-           rank, start_idx, end_idx - 1, local_count);
-    fflush(stdout);
-
     if (rank == 0) {
         printf("\n--- Parallel Brain Simulation ---\n");
         printf("MPI Ranks: %d | Brain Nodes: %d | Simulating %s ns\n", size, num_brain_nodes, argv[2]);
     }
 
-    for (int i = start_idx; i < end_idx; i++)
-        id_to_index_map[brain_nodes[i].id] = i;
-
+    // Replicas share everything loaded above and run back to back, each
+    // from empty node state with a fresh exchange and its own seeds
     int num_ns_to_simulate = atoi(argv[2]);
+    int start_idx = 0, end_idx = 0;
+    getBaseSeed();
+    if (sim_options.replicas > 1)
+        initEnsemble(sim_options.replicas);
+
+    for (int replica = 0; replica < sim_options.replicas; replica++) {
+        if (replica > 0) {
+            resetNodeState();
+            memset(&sim_stats, 0, sizeof(sim_stats));
+            freeSignalExchange();
+            initSignalExchange(size);
+        }
+        if (sim_options.replicas > 1 && rank == 0)
+            printf("\n--- Replica %d (seed %llu) ---\n", replica, (unsigned long long)getReplicaSeed(replica));
+        seedRandom(getReplicaSeed(replica) + rank);
+
+        char report_file[512];
+        replicaReportName(report_file, sizeof(report_file), replica);
+        runSimulation(num_ns_to_simulate, report_file, &start_idx, &end_idx);
+
+        if (sim_options.replicas > 1)
+            recordReplica(replica, start_idx, end_idx);
+    }
+
+    if (sim_options.replicas > 1) {
+        reportEnsemble(sim_options.stats_json);
+        freeEnsemble();
+    }
+    if (sim_options.numa_report)
+        reportNumaPlacement(start_idx, end_idx);
+
+    // Every rank holds the full graph
+    freeMemory();
+    freeNodeIdIndex();
+    freeNodeOrder();
+    freeCompactEdges();
+
+    freeSignalExchange();
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
+
+// -------------------------------
+// One run over the loaded graph, from the first iteration to the
+// report. Leaves this rank's final node range in *start_out, *end_out
+// -------------------------------
+static void runSimulation(int num_ns_to_simulate, const char *report_file, int *start_out, int *end_out) {
+    initPartition(num_brain_nodes);
+    int start_idx = getRankStartIndex(rank);
+    int end_idx = getRankStartIndex(rank + 1);
+    int local_count = end_idx - start_idx;
+
+    printf("[Rank %d] Handling brain nodes from %d to %d (count = %d)\n",
+           rank, start_idx, end_idx - 1, local_count);
+    fflush(stdout);
+
     int total_iterations = 0, current_ns_iterations = 0;
     int max_iteration_per_ns = -1, min_iteration_per_ns = -1;
     time_t seconds = 0, start_seconds = getCurrentSeconds();
 
+    if (sim_options.trace_file)
+        initTrace(sim_options.trace_events);
+
     // ✅ START timing here
     double start_time = MPI_Wtime();
 
-    while (elapsed_ns < num_ns_to_simulate) {
-        time_t current_seconds = getCurrentSeconds();
-        if (current_seconds != seconds) {
-            seconds = current_seconds;
-
-            if ((seconds - start_seconds) % MIN_LENGTH_NS == 0) {
-                if (elapsed_ns == 0) {
-                    max_iteration_per_ns = min_iteration_per_ns = current_ns_iterations;
-                } else {
-                    if (current_ns_iterations > max_iteration_per_ns)
-                        max_iteration_per_ns = current_ns_iterations;
-                    if (current_ns_iterations < min_iteration_per_ns)
-                        min_iteration_per_ns = current_ns_iterations;
-                }
-
-                elapsed_ns++;
-                current_ns_iterations = 0;
-
-                for (int i = start_idx; i < end_idx; i++) {
-                    brain_nodes[i].signals_last_ns = brain_nodes[i].signals_this_ns;
-                    brain_nodes[i].signals_this_ns = 0;
-                }
+    int ns_tick = 0;
+
+    if (sim_options.restart_prefix) {
+        struct RunProgress progress;
+        readCheckpoint(sim_options.restart_prefix, &start_idx, &end_idx, &progress);
+        elapsed_ns = progress.elapsed_ns;
+        total_iterations = progress.total_iterations;
+        current_ns_iterations = progress.current_ns_iterations;
+        max_iteration_per_ns = progress.max_iteration_per_ns;
+        min_iteration_per_ns = progress.min_iteration_per_ns;
+        // The clock check would otherwise see a new second at once and end
+        // the resumed ns after one iteration; let it run a full length
+        seconds = start_seconds;
+    }
+
+    if (sim_options.telemetry_file)
+        initTelemetry(sim_options.telemetry_file, sim_options.telemetry_top_k, start_idx, end_idx);
+    if (sim_options.rebalance_every > 0)
+        initRebalance(start_idx, end_idx);
+
+    // Fixed-iteration mode (--iterations) keeps the ns clock for the
+    // overload logic but stops on iteration count, for repeatable benchmarks
+    while (sim_options.iterations > 0 ? total_iterations < sim_options.iterations
+                                      : elapsed_ns < num_ns_to_simulate) {
+        traceSetIteration(total_iterations);
+
+        // Async mode: every rank rolls over at the iteration rank 0 announced
+        if (sim_options.async_lag >= 0) {
+            setSignalIteration(total_iterations);
+            ns_tick = (total_iterations == getAnnouncedRollover());
+        }
+
+        if (ns_tick) {
+            phaseBegin(PHASE_NS_ROLLOVER);
+            if (sim_options.telemetry_file)
+                telemetryRecordNs(elapsed_ns, current_ns_iterations, total_iterations);
+
+            if (elapsed_ns == 0) {
+                max_iteration_per_ns = min_iteration_per_ns = current_ns_iterations;
+            } else {
+                if (current_ns_iterations > max_iteration_per_ns)
+                    max_iteration_per_ns = current_ns_iterations;
+                if (current_ns_iterations < min_iteration_per_ns)
+                    min_iteration_per_ns = current_ns_iterations;
+            }
+
+            elapsed_ns++;
+            current_ns_iterations = 0;
+
+            for (int i = start_idx; i < end_idx; i++) {
+                brain_nodes[i].signals_last_ns = brain_nodes[i].signals_this_ns;
+                brain_nodes[i].signals_this_ns = 0;
+            }
+            phaseEnd(PHASE_NS_ROLLOVER);
+
+            // Drain in-flight batches into inboxes so the saved state is complete
+            if (sim_options.checkpoint_prefix && elapsed_ns % sim_options.checkpoint_every_ns == 0) {
+                struct RunProgress progress = {
+                    elapsed_ns, total_iterations, current_ns_iterations,
+                    max_iteration_per_ns, min_iteration_per_ns
+                };
+                completeOutgoingSignals();
+                writeCheckpoint(sim_options.checkpoint_prefix, start_idx, end_idx, &progress);
             }
         }
 
+        phaseBegin(PHASE_RECEIVE);
         receiveIncomingSignals(rank);
+        phaseEnd(PHASE_RECEIVE);
 
-        for (int i = 0; i < num_brain_nodes; i++) {
+        phaseBegin(PHASE_NERVE_UPDATE);
+        for (int i = start_idx; i < end_idx; i++) {
             if (brain_nodes[i].node_type == NERVE)
                 updateNodes(i);
         }
+        phaseEnd(PHASE_NERVE_UPDATE);
 
+        phaseBegin(PHASE_NEURON_UPDATE);
         for (int i = start_idx; i < end_idx; i++) {
             if (brain_nodes[i].node_type == NEURON)
                 updateNodes(i);
         }
+        phaseEnd(PHASE_NEURON_UPDATE);
 
+        phaseBegin(PHASE_SEND);
+        flushOutgoingSignals();
+        phaseEnd(PHASE_SEND);
+
+        phaseBegin(PHASE_RECEIVE);
         receiveIncomingSignals(rank);
-        MPI_Barrier(MPI_COMM_WORLD);
+        phaseEnd(PHASE_RECEIVE);
+
+        // Rank 0's clock decides ns rollover; the allreduce doubles as the
+        // end-of-iteration barrier so every rank rolls over (and stops) together
+        int local_tick = 0;
+        if (rank == 0) {
+            time_t current_seconds = getCurrentSeconds();
+            if (current_seconds != seconds) {
+                seconds = current_seconds;
+                local_tick = ((seconds - start_seconds) % MIN_LENGTH_NS == 0);
+            }
+        }
+        phaseBegin(PHASE_BARRIER);
+        if (sim_options.async_lag >= 0) {
+            // Announce far enough ahead that every rank has our batch
+            // carrying it before it can reach that iteration
+            if (local_tick && getAnnouncedRollover() <= total_iterations)
+                announceRollover(total_iterations + sim_options.async_lag + 2);
+            waitForPeers(total_iterations, sim_options.async_lag);
+        } else {
+            MPI_Allreduce(&local_tick, &ns_tick, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+        }
+        phaseEnd(PHASE_BARRIER);
+
+        phaseBegin(PHASE_RECEIVE);
+        endSignalEpoch();
+        phaseEnd(PHASE_RECEIVE);
         current_ns_iterations++;
         total_iterations++;
+
+        if (sim_options.rebalance_every > 0 && total_iterations % sim_options.rebalance_every == 0) {
+            // Ranks may still be waiting on each other's sends; settle them
+            // before the blocking collectives in rebalancing
+            if (sim_options.async_lag >= 0)
+                completeOutgoingSignals();
+            rebalanceNodes(&start_idx, &end_idx, total_iterations, sim_options.rebalance_threshold);
+        }
     }
 
-    MPI_Barrier(MPI_COMM_WORLD);
-    receiveIncomingSignals(rank);
-    usleep(50000);
-    MPI_Barrier(MPI_COMM_WORLD);
+    sim_stats.run_time = MPI_Wtime() - start_time;
+    sim_stats.iterations = total_iterations;
+
+    // Every rank stops at the same iteration; deliver everything still in
+    // flight before the final counts are taken
+    drainSignalExchange();
 
-    int *local_counts = malloc(local_count * sizeof(int));
-    for (int i = 0; i < local_count; i++)
-        local_counts[i] = brain_nodes[start_idx + i].total_signals_recieved;
+    if (sim_options.telemetry_file)
+        finishTelemetry();
 
+    int *local_counts = NULL;
     int *global_counts = NULL;
     int *recvcounts = NULL;
     int *displs = NULL;
 
-    if (rank == 0) {
-        global_counts = malloc(num_brain_nodes * sizeof(int));
-        recvcounts = malloc(size * sizeof(int));
-        displs = malloc(size * sizeof(int));
-        int offset = 0;
-        for (int r = 0; r < size; r++) {
-            int count = num_brain_nodes / size + (r < remainder ? 1 : 0);
-            recvcounts[r] = count;
-            displs[r] = offset;
-            offset += count;
+    if (sim_options.report_format == REPORT_TEXT) {
+        // Per node: total received, then nerve inputs and outputs
+        const int stride = 1 + 2 * NUM_SIGNAL_TYPES;
+        local_count = end_idx - start_idx;
+        local_counts = malloc((local_count ? local_count : 1) * stride * sizeof(int));
+        for (int i = 0; i < local_count; i++) {
+            struct NeuronNerveStruct *node = &brain_nodes[start_idx + i];
+            int *rec = &local_counts[i * stride];
+            rec[0] = node->total_signals_recieved;
+            memcpy(rec + 1, node->num_nerve_inputs, NUM_SIGNAL_TYPES * sizeof(int));
+            memcpy(rec + 1 + NUM_SIGNAL_TYPES, node->num_nerve_outputs, NUM_SIGNAL_TYPES * sizeof(int));
         }
-    }
 
-    MPI_Gatherv(local_counts, local_count, MPI_INT,
-                global_counts, recvcounts, displs, MPI_INT,
-                0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            global_counts = malloc(num_brain_nodes * stride * sizeof(int));
+            recvcounts = malloc(size * sizeof(int));
+            displs = malloc(size * sizeof(int));
+            for (int r = 0; r < size; r++) {
+                recvcounts[r] = (getRankStartIndex(r + 1) - getRankStartIndex(r)) * stride;
+                displs[r] = getRankStartIndex(r) * stride;
+            }
+        }
 
-    if (rank == 0) {
-        for (int i = 0; i < num_brain_nodes; i++) {
-            brain_nodes[i].total_signals_recieved = global_counts[i];
+        MPI_Gatherv(local_counts, local_count * stride, MPI_INT,
+                    global_counts, recvcounts, displs, MPI_INT,
+                    0, MPI_COMM_WORLD);
+
+        if (rank == 0) {
+            for (int i = 0; i < num_brain_nodes; i++) {
+                int *rec = &global_counts[i * stride];
+                brain_nodes[i].total_signals_recieved = rec[0];
+                memcpy(brain_nodes[i].num_nerve_inputs, rec + 1, NUM_SIGNAL_TYPES * sizeof(int));
+                memcpy(brain_nodes[i].num_nerve_outputs, rec + 1 + NUM_SIGNAL_TYPES, NUM_SIGNAL_TYPES * sizeof(int));
+            }
+            generateReport(report_file);
         }
+    } else {
+        // Each rank writes its own nodes straight into the shared file
+        writeParallelReport(report_file, sim_options.report_format, start_idx, end_idx);
+    }
 
-        generateReport(OUTPUT_REPORT_FILENAME);
+    if (rank == 0) {
         printf("\n Simulation complete.\n");
-        printf(" Report saved to: %s\n", OUTPUT_REPORT_FILENAME);
+        printf(" Report saved to: %s\n", report_file);
         printf(" Iterations: %d (max %d/ns, min %d/ns)\n",
                total_iterations, max_iteration_per_ns, min_iteration_per_ns);
 
@@ -222,22 +368,17 @@ int main(int argc, char **argv) {
         printf(" Total simulation time: %.6f seconds\n", end_time - start_time);
     }
 
-    MPI_Barrier(MPI_COMM_WORLD);
-
-    if (rank == 0) {
-        freeMemory();
-    } else {
-        for (int i = 0; i < num_brain_nodes; i++) {
-            free(brain_nodes[i].signalInbox);
-            free(brain_nodes[i].num_nerve_inputs);
-            free(brain_nodes[i].num_nerve_outputs);
-        }
-        free(brain_nodes);
-        free(edges);
+    // An ensemble reports its statistics once, over every replica
+    if (sim_options.replicas == 1)
+        reportStats(sim_options.stats_json);
+    if (sim_options.trace_file) {
+        writeTrace(sim_options.trace_file);
+        freeTrace();
     }
+    MPI_Barrier(MPI_COMM_WORLD);
 
-    free(id_to_index_map);
-    free(id_to_index);
+    if (sim_options.rebalance_every > 0)
+        freeRebalance();
     free(local_counts);
     if (rank == 0) {
         free(global_counts);
@@ -245,8 +386,6 @@ int main(int argc, char **argv) {
         free(displs);
     }
 
-    MPI_Type_free(&MPI_PackedSignal);
-    MPI_Finalize();
-    return EXIT_SUCCESS;
+    *start_out = start_idx;
+    *end_out = end_idx;
 }
-
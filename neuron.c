@@ -17,17 +17,26 @@ static const float NEURON_TYPE_SIGNAL_WEIGHTS[6] = {
 };
 
 extern int rank, size;
-extern int *id_to_index_map;
+
+// Node kinds for kernel dispatch: the six neuron types by weight index,
+// then nerves
+#define NERVE_KIND 6
+#define NUM_NODE_KINDS 7
+
+enum EdgeLayout { LAYOUT_FULL, LAYOUT_COMPACT16, LAYOUT_COMPACT32, NUM_EDGE_LAYOUTS };
 
 // -------------------------------
-// Update a neuron or nerve node
+// Generic path: node kind and edge layout are tested per signal and per
+// chunk. Built alone with GENERIC_KERNELS, and used for nodes no
+// specialised kernel covers
 // -------------------------------
-void updateNodes(int node_idx) {
+static void updateNodeGeneric(int node_idx) {
     // --- Random firing for nerves ---
     if (brain_nodes[node_idx].num_edges > 0 &&
         brain_nodes[node_idx].node_type == NERVE) {
 
         int num_signals_to_fire = getRandomInteger(0, MAX_RANDOM_NERVE_SIGNALS_TO_FIRE);
+        sim_stats.counters[STAT_SIGNALS_GENERATED] += num_signals_to_fire;
 
         for (int i = 0; i < num_signals_to_fire; i++) {
             float signalValue = generateDecimalRandomNumber(MAX_SIGNAL_VALUE);
@@ -40,6 +49,9 @@ void updateNodes(int node_idx) {
         }
     }
 
+    if (brain_nodes[node_idx].num_outstanding_signals > sim_stats.counters[STAT_PEAK_INBOX])
+        sim_stats.counters[STAT_PEAK_INBOX] = brain_nodes[node_idx].num_outstanding_signals;
+
     // --- Process all inboxed signals ---
     for (int i = 0; i < brain_nodes[node_idx].num_outstanding_signals; i++) {
         struct SignalStruct *sig = &brain_nodes[node_idx].signalInbox[i];
@@ -53,6 +65,7 @@ void updateNodes(int node_idx) {
         brain_nodes[node_idx].signals_this_ns++;
     }
 
+    sim_stats.counters[STAT_SIGNALS_PROCESSED] += brain_nodes[node_idx].num_outstanding_signals;
     brain_nodes[node_idx].total_signals_recieved += brain_nodes[node_idx].num_outstanding_signals;
     brain_nodes[node_idx].num_outstanding_signals = 0;
 }
@@ -98,19 +111,38 @@ void fireSignal(int node_idx, float signal, int signal_type) {
 
         if (edge_idx < 0 || edge_idx >= num_edges) return;
 
-        // --- Determine target ID ---
-        int tgt_id = (edges[edge_idx].from == brain_nodes[node_idx].id)
-                     ? edges[edge_idx].to
-                     : edges[edge_idx].from;
+        // --- Edge parameters, from the compact table if there is one ---
+        int from_idx, to_idx;
+        float max_value, type_weight;
+        if (compact_edges.index_bits == 16) {
+            const struct CompactEdge16 *c = &compact_edges.e16[edge_idx];
+            from_idx = compact16Index(c->from_idx);
+            to_idx = compact16Index(c->to_idx);
+            max_value = (float)c->max_code * compact_edges.max_scale;
+            type_weight = compact_edges.weight_value[c->weight_code[signal_type]];
+        } else if (compact_edges.index_bits == 32) {
+            const struct CompactEdge32 *c = &compact_edges.e32[edge_idx];
+            from_idx = (int)c->from_idx;
+            to_idx = (int)c->to_idx;
+            max_value = (float)c->max_code * compact_edges.max_scale;
+            type_weight = compact_edges.weight_value[c->weight_code[signal_type]];
+        } else {
+            from_idx = edges[edge_idx].from_idx;
+            to_idx = edges[edge_idx].to_idx;
+            max_value = edges[edge_idx].max_value;
+            type_weight = edges[edge_idx].messageTypeWeightings[signal_type];
+        }
+
+        // --- Determine target index ---
+        int tgt_idx = (from_idx == node_idx) ? to_idx : from_idx;
 
         // --- Limit signal chunk ---
         float chunk = signal;
-        if (chunk > edges[edge_idx].max_value)
-            chunk = edges[edge_idx].max_value;
+        if (chunk > max_value)
+            chunk = max_value;
         signal -= chunk;
 
         // --- Apply edge weight ---
-        float type_weight = edges[edge_idx].messageTypeWeightings[signal_type];
         chunk *= type_weight;
 
         if (brain_nodes[node_idx].node_type == NERVE &&
@@ -119,10 +151,162 @@ void fireSignal(int node_idx, float signal, int signal_type) {
         }
 
         struct SignalStruct s = { .type = signal_type, .value = chunk };
-        sendSignalToRank(tgt_id, s, rank, size);
+        sendSignalToRank(tgt_idx, s, rank, size);
     }
 }
 
+#ifndef GENERIC_KERNELS
+// -------------------------------
+// Specialised kernels. One kernel per (edge layout, node kind) pair is
+// stamped out from the inline bodies below with both as constants, so
+// the nerve/neuron test, the neuron weight lookup and the edge layout
+// branch all fold away and a node pays for its dispatch once per step
+// rather than per signal or chunk. Random draws happen in exactly the
+// generic order, so both paths simulate the same run.
+//
+// fireKernel does none of the generic path's per-signal checks. Whether
+// a node has edges is tested once per node step. Signal types are valid
+// from generation, and checked where signals come in from outside
+// (deliverIncomingSignal, readCheckpoint, brainSimInject). Edge lists only
+// ever hold indices linkNodesToEdges put there.
+// -------------------------------
+static inline __attribute__((always_inline))
+void fireKernel(struct NeuronNerveStruct *node, int node_idx, float signal, int signal_type,
+                const int layout, const int nerve) {
+    const int *edge_list = node->edges;
+    const int degree = node->num_edges;
+    int *outputs = node->num_nerve_outputs;
+
+    while (signal >= SIGNAL_THRESHOLD) {
+        int edge_idx = edge_list[getRandomInteger(0, degree)];
+
+        int from_idx, to_idx;
+        float max_value, type_weight;
+        if (layout == LAYOUT_COMPACT16) {
+            const struct CompactEdge16 *c = &compact_edges.e16[edge_idx];
+            from_idx = compact16Index(c->from_idx);
+            to_idx = compact16Index(c->to_idx);
+            max_value = (float)c->max_code * compact_edges.max_scale;
+            type_weight = compact_edges.weight_value[c->weight_code[signal_type]];
+        } else if (layout == LAYOUT_COMPACT32) {
+            const struct CompactEdge32 *c = &compact_edges.e32[edge_idx];
+            from_idx = (int)c->from_idx;
+            to_idx = (int)c->to_idx;
+            max_value = (float)c->max_code * compact_edges.max_scale;
+            type_weight = compact_edges.weight_value[c->weight_code[signal_type]];
+        } else {
+            from_idx = edges[edge_idx].from_idx;
+            to_idx = edges[edge_idx].to_idx;
+            max_value = edges[edge_idx].max_value;
+            type_weight = edges[edge_idx].messageTypeWeightings[signal_type];
+        }
+
+        int tgt_idx = (from_idx == node_idx) ? to_idx : from_idx;
+
+        float chunk = signal;
+        if (chunk > max_value)
+            chunk = max_value;
+        signal -= chunk;
+        chunk *= type_weight;
+
+        if (nerve && outputs)
+            outputs[signal_type]++;
+
+        struct SignalStruct s = { .type = signal_type, .value = chunk };
+        sendSignalToRank(tgt_idx, s, rank, size);
+    }
+}
+
+static inline __attribute__((always_inline))
+void nodeKernel(int node_idx, const int layout, const int kind) {
+    struct NeuronNerveStruct *node = &brain_nodes[node_idx];
+    const int nerve = kind == NERVE_KIND;
+    const int fires = node->num_edges > 0;
+
+    // --- Random firing for nerves ---
+    if (nerve && fires) {
+        int num_signals_to_fire = getRandomInteger(0, MAX_RANDOM_NERVE_SIGNALS_TO_FIRE);
+        sim_stats.counters[STAT_SIGNALS_GENERATED] += num_signals_to_fire;
+
+        for (int i = 0; i < num_signals_to_fire; i++) {
+            float signalValue = generateDecimalRandomNumber(MAX_SIGNAL_VALUE);
+            int signalType = getRandomInteger(0, NUM_SIGNAL_TYPES);
+            if (node->num_nerve_inputs)
+                node->num_nerve_inputs[signalType]++;
+            fireKernel(node, node_idx, signalValue, signalType, layout, 1);
+        }
+    }
+
+    if (node->num_outstanding_signals > sim_stats.counters[STAT_PEAK_INBOX])
+        sim_stats.counters[STAT_PEAK_INBOX] = node->num_outstanding_signals;
+
+    // --- Process all inboxed signals; self-loops can append while we go ---
+    for (int i = 0; i < node->num_outstanding_signals; i++) {
+        float signal = node->signalInbox[i].value;
+        int signal_type = node->signalInbox[i].type;
+
+        if (nerve) {
+            if (node->num_nerve_inputs)
+                node->num_nerve_inputs[signal_type]++;
+            if (node->num_nerve_outputs)
+                node->num_nerve_outputs[signal_type]++;
+            if (fires)
+                fireKernel(node, node_idx, signal, signal_type, layout, 1);
+        } else {
+            signal *= NEURON_TYPE_SIGNAL_WEIGHTS[kind];
+
+            int recent = node->signals_last_ns + node->signals_this_ns;
+            int dropped = 0;
+            if (recent > 500) {
+                if (getRandomInteger(0, 2) == 1) signal /= 2.0;
+                if (getRandomInteger(0, 3) == 1) dropped = 1;
+            }
+            if (!dropped && fires)
+                fireKernel(node, node_idx, signal, signal_type, layout, 0);
+        }
+        node->signals_this_ns++;
+    }
+
+    sim_stats.counters[STAT_SIGNALS_PROCESSED] += node->num_outstanding_signals;
+    node->total_signals_recieved += node->num_outstanding_signals;
+    node->num_outstanding_signals = 0;
+}
+
+#define NODE_KERNEL(layout, kind) \
+    static void nodeKernel_##layout##_##kind(int node_idx) { nodeKernel(node_idx, layout, kind); }
+#define NODE_KERNEL_NAME(layout, kind) nodeKernel_##layout##_##kind,
+#define FOR_EACH_NODE_KIND(X, layout) \
+    X(layout, 0) X(layout, 1) X(layout, 2) X(layout, 3) X(layout, 4) X(layout, 5) X(layout, 6)
+
+FOR_EACH_NODE_KIND(NODE_KERNEL, LAYOUT_FULL)
+FOR_EACH_NODE_KIND(NODE_KERNEL, LAYOUT_COMPACT16)
+FOR_EACH_NODE_KIND(NODE_KERNEL, LAYOUT_COMPACT32)
+
+static void (*const node_kernels[NUM_EDGE_LAYOUTS][NUM_NODE_KINDS])(int) = {
+    [LAYOUT_FULL] = { FOR_EACH_NODE_KIND(NODE_KERNEL_NAME, LAYOUT_FULL) },
+    [LAYOUT_COMPACT16] = { FOR_EACH_NODE_KIND(NODE_KERNEL_NAME, LAYOUT_COMPACT16) },
+    [LAYOUT_COMPACT32] = { FOR_EACH_NODE_KIND(NODE_KERNEL_NAME, LAYOUT_COMPACT32) },
+};
+#endif
+
+// -------------------------------
+// Update a neuron or nerve node: pick its kernel once and run every
+// signal of this step through it
+// -------------------------------
+void updateNodes(int node_idx) {
+#ifndef GENERIC_KERNELS
+    const struct NeuronNerveStruct *node = &brain_nodes[node_idx];
+    int kind = node->node_type == NERVE ? NERVE_KIND : neuronTypeToIndex(node->neuron_type);
+    int layout = compact_edges.index_bits == 16 ? LAYOUT_COMPACT16 :
+                 compact_edges.index_bits == 32 ? LAYOUT_COMPACT32 : LAYOUT_FULL;
+    if (kind >= 0) {
+        node_kernels[layout][kind](node_idx);
+        return;
+    }
+#endif
+    updateNodeGeneric(node_idx);
+}
+
 // -------------------------------
 // Generate simulation report
 // -------------------------------
@@ -136,9 +320,10 @@ void generateReport(const char *filename) {
     fprintf(out, "Simulation ran with %d neurons, %d nerves and %d total edges until %d ns\n\n",
             num_neurons, num_nerves, num_edges, elapsed_ns);
 
-    // --- Report for nerves ---
+    // --- Report for nerves, in graph file order ---
     int nerve_count = 0;
-    for (int i = 0; i < num_brain_nodes; i++) {
+    for (int p = 0; p < num_brain_nodes; p++) {
+        int i = getNodeAtFilePosition(p);
         if (brain_nodes[i].node_type == NERVE) {
             fprintf(out, "Nerve %d (ID: %d)\n", nerve_count++, brain_nodes[i].id);
             for (int j = 0; j < NUM_SIGNAL_TYPES; j++) {
@@ -151,7 +336,8 @@ void generateReport(const char *filename) {
     // --- Report for neurons ---
     fprintf(out, "\n");
     int neuron_count = 0;
-    for (int i = 0; i < num_brain_nodes; i++) {
+    for (int p = 0; p < num_brain_nodes; p++) {
+        int i = getNodeAtFilePosition(p);
         if (brain_nodes[i].node_type == NEURON) {
             fprintf(out, "Neuron %d (ID: %d), total signals received: %d\n",
                     neuron_count++, brain_nodes[i].id, brain_nodes[i].total_signals_recieved);
@@ -165,24 +351,6 @@ void generateReport(const char *filename) {
 // Clean up and free memory
 // -------------------------------
 void freeMemory() {
-    for (int i = 0; i < num_edges; i++) {
-        free(edges[i].messageTypeWeightings);
-    }
-    free(edges);
-
-    for (int i = 0; i < num_brain_nodes; i++) {
-        free(brain_nodes[i].signalInbox);
-        free(brain_nodes[i].edges);
-        free(brain_nodes[i].num_nerve_inputs);
-        free(brain_nodes[i].num_nerve_outputs);
-    }
-
-    free(brain_nodes);
-
-    // Cleanup shared global map
-    if (id_to_index_map != NULL) {
-        free(id_to_index_map);
-        id_to_index_map = NULL;
-    }
+    freeGraph();
 }
 
@@ -0,0 +1,313 @@
+// -------------------------------
+// node_order.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brain.h"
+#include <mpi.h>
+
+// Optional renumbering of node storage after loading (--reorder). Dense
+// indices, and with them memory layout and the contiguous ownership
+// ranges, follow a Hilbert curve through the x/y/z coordinates or a
+// reverse Cuthill-McKee ordering of the edge graph instead of file
+// order. Edges are then grouped by their new source index. Node IDs are
+// untouched, and reports list nodes in their original file position.
+
+#define HILBERT_BITS 16
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank;
+
+static int *file_position = NULL;   // dense index -> position in the graph file
+static int *file_node = NULL;       // position in the graph file -> dense index
+
+struct OrderKey {
+    uint64_t key;
+    int idx;
+};
+
+static int compareOrderKeys(const void *a, const void *b) {
+    const struct OrderKey *x = a, *y = b;
+    if (x->key != y->key)
+        return x->key < y->key ? -1 : 1;
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+static void *allocOrDie(size_t bytes) {
+    void *p = malloc(bytes > 0 ? bytes : 1);
+    if (!p) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %zu bytes for node reordering\n", rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return p;
+}
+
+// -------------------------------
+// Distance along a 3-D Hilbert curve (Skilling's transpose method)
+// -------------------------------
+static uint64_t hilbertKey(uint32_t x[3]) {
+    uint32_t top = 1u << (HILBERT_BITS - 1);
+
+    for (uint32_t q = top; q > 1; q >>= 1) {
+        uint32_t p = q - 1;
+        for (int i = 0; i < 3; i++) {
+            if (x[i] & q) {
+                x[0] ^= p;
+            } else {
+                uint32_t t = (x[0] ^ x[i]) & p;
+                x[0] ^= t;
+                x[i] ^= t;
+            }
+        }
+    }
+
+    for (int i = 1; i < 3; i++)
+        x[i] ^= x[i - 1];
+    uint32_t t = 0;
+    for (uint32_t q = top; q > 1; q >>= 1)
+        if (x[2] & q) t ^= q - 1;
+    for (int i = 0; i < 3; i++)
+        x[i] ^= t;
+
+    uint64_t key = 0;
+    for (int b = HILBERT_BITS - 1; b >= 0; b--)
+        for (int i = 0; i < 3; i++)
+            key = (key << 1) | ((x[i] >> b) & 1);
+    return key;
+}
+
+static void hilbertOrder(int *order) {
+    float lo[3] = { 0 }, hi[3] = { 0 };
+    for (int i = 0; i < num_brain_nodes; i++) {
+        float c[3] = { brain_nodes[i].x, brain_nodes[i].y, brain_nodes[i].z };
+        for (int d = 0; d < 3; d++) {
+            if (i == 0 || c[d] < lo[d]) lo[d] = c[d];
+            if (i == 0 || c[d] > hi[d]) hi[d] = c[d];
+        }
+    }
+
+    struct OrderKey *keys = allocOrDie(num_brain_nodes * sizeof(struct OrderKey));
+    const double scale = (double)((1u << HILBERT_BITS) - 1);
+    for (int i = 0; i < num_brain_nodes; i++) {
+        float c[3] = { brain_nodes[i].x, brain_nodes[i].y, brain_nodes[i].z };
+        uint32_t cell[3];
+        for (int d = 0; d < 3; d++)
+            cell[d] = hi[d] > lo[d] ? (uint32_t)((c[d] - lo[d]) / (hi[d] - lo[d]) * scale) : 0;
+        keys[i].key = hilbertKey(cell);
+        keys[i].idx = i;
+    }
+
+    qsort(keys, num_brain_nodes, sizeof(struct OrderKey), compareOrderKeys);
+    for (int k = 0; k < num_brain_nodes; k++)
+        order[k] = keys[k].idx;
+    free(keys);
+}
+
+// -------------------------------
+// Reverse Cuthill-McKee over the undirected edge graph. Each component
+// starts from its lowest-degree node; neighbours are queued by degree
+// -------------------------------
+static void rcmOrder(int *order) {
+    int n = num_brain_nodes;
+    int *offsets = calloc(n + 1, sizeof(int));
+    if (!offsets) {
+        fprintf(stderr, "[Rank %d] Failed to allocate adjacency for node reordering\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int j = 0; j < num_edges; j++) {
+        int a = edges[j].from_idx, b = edges[j].to_idx;
+        if (a < 0 || b < 0 || a == b) continue;
+        offsets[a + 1]++;
+        offsets[b + 1]++;
+    }
+    for (int i = 0; i < n; i++)
+        offsets[i + 1] += offsets[i];
+
+    int *adjacency = allocOrDie((size_t)offsets[n] * sizeof(int));
+    int *fill = allocOrDie(n * sizeof(int));
+    memcpy(fill, offsets, n * sizeof(int));
+    for (int j = 0; j < num_edges; j++) {
+        int a = edges[j].from_idx, b = edges[j].to_idx;
+        if (a < 0 || b < 0 || a == b) continue;
+        adjacency[fill[a]++] = b;
+        adjacency[fill[b]++] = a;
+    }
+    free(fill);
+
+    // Nodes by (degree, index), for picking component start points and
+    // ordering each node's newly reached neighbours
+    struct OrderKey *by_degree = allocOrDie(n * sizeof(struct OrderKey));
+    for (int i = 0; i < n; i++) {
+        by_degree[i].key = (uint64_t)(offsets[i + 1] - offsets[i]);
+        by_degree[i].idx = i;
+    }
+    qsort(by_degree, n, sizeof(struct OrderKey), compareOrderKeys);
+
+    char *visited = calloc(n, 1);
+    struct OrderKey *reached = allocOrDie(n * sizeof(struct OrderKey));
+    if (!visited) {
+        fprintf(stderr, "[Rank %d] Failed to allocate adjacency for node reordering\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int head = 0, tail = 0;
+    for (int s = 0; s < n; s++) {
+        int start = by_degree[s].idx;
+        if (visited[start]) continue;
+        visited[start] = 1;
+        order[tail++] = start;
+
+        while (head < tail) {
+            int node = order[head++], count = 0;
+            for (int e = offsets[node]; e < offsets[node + 1]; e++) {
+                int next = adjacency[e];
+                if (visited[next]) continue;
+                visited[next] = 1;
+                reached[count].key = (uint64_t)(offsets[next + 1] - offsets[next]);
+                reached[count].idx = next;
+                count++;
+            }
+            qsort(reached, count, sizeof(struct OrderKey), compareOrderKeys);
+            for (int r = 0; r < count; r++)
+                order[tail++] = reached[r].idx;
+        }
+    }
+
+    for (int a = 0, b = n - 1; a < b; a++, b--) {
+        int t = order[a];
+        order[a] = order[b];
+        order[b] = t;
+    }
+
+    free(offsets);
+    free(adjacency);
+    free(by_degree);
+    free(visited);
+    free(reached);
+}
+
+// -------------------------------
+// Move node k's loaded fields to slot order[k], remap edge endpoints and
+// regroup edges by source. Runs on rank 0 after loadBrainGraph, before
+// linkNodesToEdges; inboxes and counters are still empty, so only the
+// loaded fields move and every slot keeps its own buffers
+// -------------------------------
+static void permuteNodes(const int *order) {
+    int n = num_brain_nodes;
+    struct NeuronNerveStruct *loaded = allocOrDie(n * sizeof(struct NeuronNerveStruct));
+    memcpy(loaded, brain_nodes, n * sizeof(struct NeuronNerveStruct));
+
+    int *new_index = allocOrDie(n * sizeof(int));
+    for (int k = 0; k < n; k++) {
+        struct NeuronNerveStruct *dst = &brain_nodes[k];
+        const struct NeuronNerveStruct *src = &loaded[order[k]];
+        dst->id = src->id;
+        dst->x = src->x;
+        dst->y = src->y;
+        dst->z = src->z;
+        dst->node_type = src->node_type;
+        dst->neuron_type = src->neuron_type;
+        new_index[order[k]] = k;
+    }
+    free(loaded);
+
+    // Edges: counting sort by new source index, stable in file order
+    struct EdgeStruct *old_edges = allocOrDie(num_edges * sizeof(struct EdgeStruct));
+    float *old_weights = allocOrDie((size_t)num_edges * NUM_SIGNAL_TYPES * sizeof(float));
+    int *bucket = calloc(n + 2, sizeof(int));
+    if (!bucket) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %zu bytes for node reordering\n", rank, (n + 2) * sizeof(int));
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    for (int j = 0; j < num_edges; j++) {
+        old_edges[j] = edges[j];
+        memcpy(&old_weights[(size_t)j * NUM_SIGNAL_TYPES], edges[j].messageTypeWeightings, NUM_SIGNAL_TYPES * sizeof(float));
+        if (old_edges[j].from_idx >= 0) old_edges[j].from_idx = new_index[old_edges[j].from_idx];
+        if (old_edges[j].to_idx >= 0) old_edges[j].to_idx = new_index[old_edges[j].to_idx];
+        bucket[old_edges[j].from_idx + 2]++;    // unknown sources (-1) first
+    }
+    for (int b = 0; b <= n; b++)
+        bucket[b + 1] += bucket[b];
+
+    for (int j = 0; j < num_edges; j++) {
+        int slot = bucket[old_edges[j].from_idx + 1]++;
+        float *weights = edges[slot].messageTypeWeightings;
+        edges[slot] = old_edges[j];
+        edges[slot].messageTypeWeightings = weights;
+        memcpy(weights, &old_weights[(size_t)j * NUM_SIGNAL_TYPES], NUM_SIGNAL_TYPES * sizeof(float));
+    }
+
+    free(old_edges);
+    free(old_weights);
+    free(bucket);
+    free(new_index);
+
+    // Dense indices changed under the ID index
+    buildNodeIdIndex();
+}
+
+// -------------------------------
+// Rank 0: renumber the freshly loaded graph
+// -------------------------------
+void reorderNodes(enum NodeOrdering ordering) {
+    freeNodeOrder();
+    if (ordering == ORDER_FILE)
+        return;
+
+    double began = MPI_Wtime();
+    int *order = allocOrDie(num_brain_nodes * sizeof(int));
+    if (ordering == ORDER_HILBERT)
+        hilbertOrder(order);
+    else
+        rcmOrder(order);
+
+    permuteNodes(order);
+
+    file_position = order;
+    file_node = allocOrDie(num_brain_nodes * sizeof(int));
+    for (int k = 0; k < num_brain_nodes; k++)
+        file_node[order[k]] = k;
+
+    printf("[Rank 0] Reordered %d nodes (%s) in %.3f ms\n", num_brain_nodes,
+           ordering == ORDER_HILBERT ? "hilbert" : "rcm", (MPI_Wtime() - began) * 1000.0);
+}
+
+// -------------------------------
+// Collective: share rank 0's renumbering
+// -------------------------------
+void broadcastNodeOrder(enum NodeOrdering ordering) {
+    if (ordering == ORDER_FILE)
+        return;
+
+    if (rank != 0) {
+        freeNodeOrder();
+        file_position = allocOrDie(num_brain_nodes * sizeof(int));
+        file_node = allocOrDie(num_brain_nodes * sizeof(int));
+    }
+    MPI_Bcast(file_position, num_brain_nodes, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank != 0)
+        for (int k = 0; k < num_brain_nodes; k++)
+            file_node[file_position[k]] = k;
+}
+
+// Position of a node in the graph file; the identity without reordering
+int getNodeFilePosition(int idx) {
+    return file_position ? file_position[idx] : idx;
+}
+
+// Dense index of the node at a position in the graph file
+int getNodeAtFilePosition(int position) {
+    return file_node ? file_node[position] : position;
+}
+
+void freeNodeOrder() {
+    free(file_position);
+    free(file_node);
+    file_position = file_node = NULL;
+}
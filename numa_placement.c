@@ -0,0 +1,173 @@
+// -------------------------------
+// numa_placement.c
+// -------------------------------
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "brain.h"
+#include <mpi.h>
+
+// NUMA placement for a few fat ranks per box. With --numa-bind every
+// rank binds itself, and every thread it later starts (loader, progress,
+// telemetry writer), to the CPUs of one NUMA node and prefers that
+// node's memory. Ranks on a host are spread round-robin over its nodes.
+// Node state and inboxes are then first-touched locally: rank 0's loader
+// threads fill its copy of the graph, the other ranks fill theirs from
+// the broadcasts, and inboxes (and rebalanced nodes) are only ever
+// written by their owner. --numa-report measures the result by asking
+// the kernel where the owned part of the graph arena actually lives.
+// Raw syscalls keep libnuma out of the build.
+
+#define MAX_NUMA_NODES 64
+#define MPOL_PREFERRED_MODE 1    // MPOL_PREFERRED in <numaif.h>
+#define PAGE_QUERY_BATCH 4096
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+// Highest N in a sysfs list such as "0-1,4", plus one; 0 if unreadable
+static int readListMax(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    int value, max = -1;
+    char sep;
+    while (fscanf(f, "%d", &value) == 1) {
+        if (value > max) max = value;
+        if (fscanf(f, "%c", &sep) != 1 || sep == '\n')
+            break;
+    }
+    fclose(f);
+    return max + 1;
+}
+
+// Parse a sysfs CPU list ("0-3,8-11") into a CPU set; returns CPU count
+static int readCpuList(const char *path, cpu_set_t *set) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    CPU_ZERO(set);
+    int lo, hi, count = 0;
+    char sep;
+    while (fscanf(f, "%d", &lo) == 1) {
+        hi = lo;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(f, "%d", &hi) != 1)
+                break;
+            if (fscanf(f, "%c", &sep) != 1)
+                sep = '\n';
+        }
+        for (int c = lo; c <= hi && c < CPU_SETSIZE; c++, count++)
+            CPU_SET(c, set);
+        if (sep != ',')
+            break;
+    }
+    fclose(f);
+    return count;
+}
+
+static int currentNumaNode() {
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0)
+        return -1;
+    return (int)node;
+}
+
+// -------------------------------
+// Collective: bind this rank to one NUMA node of its host. Call before
+// the graph is loaded so every later first touch is local
+// -------------------------------
+void bindToNumaNode() {
+    MPI_Comm host;
+    int local_rank, local_size;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &host);
+    MPI_Comm_rank(host, &local_rank);
+    MPI_Comm_size(host, &local_size);
+    MPI_Comm_free(&host);
+
+    int nodes = readListMax("/sys/devices/system/node/online");
+    if (nodes > MAX_NUMA_NODES) nodes = MAX_NUMA_NODES;
+    if (nodes <= 1) {
+        if (rank == 0)
+            printf("[Rank 0] Single NUMA node, --numa-bind has nothing to do\n");
+        return;
+    }
+
+    int node = local_rank % nodes;
+    char path[96];
+    cpu_set_t cpus;
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    int count = readCpuList(path, &cpus);
+    if (count == 0 || sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        fprintf(stderr, "[Rank %d] Could not bind to the CPUs of NUMA node %d\n", rank, node);
+        return;
+    }
+
+    unsigned long mask = 1UL << node;
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, &mask, (unsigned long)MAX_NUMA_NODES + 1) != 0)
+        fprintf(stderr, "[Rank %d] Could not prefer memory of NUMA node %d\n", rank, node);
+
+    printf("[Rank %d] Bound to NUMA node %d (%d CPUs, host rank %d of %d)\n",
+           rank, node, count, local_rank, local_size);
+}
+
+// Count resident pages in [begin, end) and how many sit on `node`
+static void countPages(const void *begin, const void *end, int node, long long *resident, long long *local) {
+    long page = sysconf(_SC_PAGESIZE);
+    uintptr_t first = (uintptr_t)begin & ~(uintptr_t)(page - 1);
+    void *pages[PAGE_QUERY_BATCH];
+    int status[PAGE_QUERY_BATCH];
+
+    for (uintptr_t addr = first; addr < (uintptr_t)end;) {
+        int count = 0;
+        for (; count < PAGE_QUERY_BATCH && addr < (uintptr_t)end; count++, addr += page)
+            pages[count] = (void *)addr;
+        // With no target nodes move_pages only reports where each page is
+        if (syscall(SYS_move_pages, 0, (unsigned long)count, pages, NULL, status, 0) != 0)
+            return;
+        for (int i = 0; i < count; i++) {
+            if (status[i] < 0)
+                continue;    // never touched
+            (*resident)++;
+            if (status[i] == node)
+                (*local)++;
+        }
+    }
+}
+
+// -------------------------------
+// Collective: report the share of this rank's resident node state,
+// counters and inboxes that lives on the NUMA node it is running on
+// -------------------------------
+void reportNumaPlacement(int start_idx, int end_idx) {
+    long long resident = 0, local = 0;
+    int node = currentNumaNode();
+
+    if (end_idx > start_idx && node >= 0) {
+        // The arena keeps each of these contiguous in node order
+        const struct NeuronNerveStruct *first = &brain_nodes[start_idx], *last = &brain_nodes[end_idx - 1];
+        countPages(first, last + 1, node, &resident, &local);
+        countPages(first->num_nerve_inputs, last->num_nerve_outputs + NUM_SIGNAL_TYPES, node, &resident, &local);
+        countPages(first->signalInbox, last->signalInbox + SIGNAL_INBOX_SIZE, node, &resident, &local);
+    }
+
+    double ratio = resident ? (double)local / resident : 1.0, min_ratio, max_ratio;
+    long long pages[2] = { resident, local }, total[2];
+    MPI_Reduce(&ratio, &min_ratio, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&ratio, &max_ratio, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(pages, total, 2, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        double overall = total[0] ? 100.0 * total[1] / total[0] : 100.0;
+        printf(" NUMA placement: %.1f%% of %lld resident owned-node pages local "
+               "(per rank min %.1f%%, max %.1f%%), %.1f%% remote\n",
+               overall, total[0], 100.0 * min_ratio, 100.0 * max_ratio, 100.0 - overall);
+    }
+}
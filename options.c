@@ -0,0 +1,334 @@
+// -------------------------------
+// options.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brain.h"
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank;
+
+struct SimOptions sim_options = {
+    .precision = PRECISION_FP32,
+    .stats_json = NULL,
+    .trace_file = NULL,
+    .trace_events = DEFAULT_TRACE_EVENTS,
+    .iterations = 0,
+    .checkpoint_prefix = NULL,
+    .checkpoint_every_ns = 10,
+    .restart_prefix = NULL,
+    .report_file = OUTPUT_REPORT_FILENAME,
+    .report_format = REPORT_TEXT,
+    .telemetry_file = NULL,
+    .telemetry_top_k = DEFAULT_TELEMETRY_TOP_K,
+    .rebalance_every = 0,
+    .rebalance_threshold = DEFAULT_REBALANCE_THRESHOLD,
+    .progress_thread = 0,
+    .exchange = EXCHANGE_P2P,
+    .rma_buffer_kb = DEFAULT_RMA_BUFFER_KB,
+    .async_lag = -1,
+    .loader_threads = 0,
+    .threads = 0,
+    .replicas = 1,
+    .seed = -1,
+    .huge_pages = 0,
+    .reorder = ORDER_FILE,
+    .numa_bind = 0,
+    .numa_report = 0,
+    .edge_format = EDGE_FULL,
+};
+
+// -------------------------------
+// Print usage (rank 0 only)
+// -------------------------------
+void printUsage(const char *prog) {
+    if (rank != 0)
+        return;
+    fprintf(stderr, "Usage: %s <brain_graph_file> <num_nanoseconds> [options]\n", prog);
+    fprintf(stderr, "  --iterations <n>             Run exactly n iterations instead of until <num_nanoseconds>\n");
+    fprintf(stderr, "  --precision fp32|fp16|bf16   Wire precision of remote signal values\n");
+    fprintf(stderr, "  --seed <n>                   Base random seed (default: wall clock)\n");
+    fprintf(stderr, "  --replicas <n>               Run n independently seeded replicas over one loaded graph;\n");
+    fprintf(stderr, "                               reports go to <report>.<replica>, aggregates to\n");
+    fprintf(stderr, "                               <report>.ensemble\n");
+    fprintf(stderr, "  --checkpoint <prefix>        Write <prefix>.<rank> checkpoints at ns rollover\n");
+    fprintf(stderr, "  --checkpoint-every <ns>      Simulated ns between checkpoints (default 10)\n");
+    fprintf(stderr, "  --restart <prefix>           Resume from <prefix>.* (any previous rank count)\n");
+    fprintf(stderr, "  --exchange <mode>            Signal exchange: p2p (batched Isend), neighbor (neighbourhood\n");
+    fprintf(stderr, "                               collective) or rma (one-sided puts into remote inboxes)\n");
+    fprintf(stderr, "  --rma-buffer <KB>            Per-epoch RMA receive area per rank (default %d)\n", DEFAULT_RMA_BUFFER_KB);
+    fprintf(stderr, "  --async-lag <k>              Drop the per-iteration collective; ranks may run up to k\n");
+    fprintf(stderr, "                               iterations ahead of each other (p2p exchange only)\n");
+    fprintf(stderr, "  --loader-threads <n>         Threads parsing the graph file (default: all online CPUs)\n");
+    fprintf(stderr, "  --threads <n>                Worker threads of the shared-memory engine (brain_shm only;\n");
+    fprintf(stderr, "                               default: all online CPUs)\n");
+    fprintf(stderr, "  --reorder <order>            Node storage order: file (default), hilbert (space-filling\n");
+    fprintf(stderr, "                               curve over x/y/z) or rcm (reverse Cuthill-McKee on edges)\n");
+    fprintf(stderr, "  --edge-format full|compact   Edge table used for propagation: full floats, or 8-bit\n");
+    fprintf(stderr, "                               weightings and 16-bit limits (exact for two-decimal inputs)\n");
+    fprintf(stderr, "  --huge-pages                 Back graph memory with transparent huge pages\n");
+    fprintf(stderr, "  --numa-bind                  Bind each rank and its threads to one NUMA node of its host\n");
+    fprintf(stderr, "  --numa-report                Report how much owned node memory is NUMA-local\n");
+    fprintf(stderr, "  --progress-thread            Drive signal send/receive from a dedicated thread\n");
+    fprintf(stderr, "  --rebalance-every <n>        Check load balance every n iterations and migrate nodes\n");
+    fprintf(stderr, "  --rebalance-threshold <r>    Max/mean update time that triggers migration (default %.2f)\n", DEFAULT_REBALANCE_THRESHOLD);
+    fprintf(stderr, "  --report <file>              Report file (default %s)\n", OUTPUT_REPORT_FILENAME);
+    fprintf(stderr, "  --report-format <fmt>        text (gathered on rank 0), binary or fixed-text (MPI-IO)\n");
+    fprintf(stderr, "  --stats-json <file>          Write aggregated per-rank stats as JSON\n");
+    fprintf(stderr, "  --telemetry <file>           Stream per-ns aggregates as JSON lines\n");
+    fprintf(stderr, "  --telemetry-top <k>          Busiest neurons listed per ns (default %d)\n", DEFAULT_TELEMETRY_TOP_K);
+    fprintf(stderr, "  --trace <file>               Write a Chrome/Perfetto timeline of loop phases\n");
+    fprintf(stderr, "  --trace-events <n>           Events kept per rank in the trace ring (default %d)\n", DEFAULT_TRACE_EVENTS);
+}
+
+// -------------------------------
+// Parse optional flags after <brain_graph_file> <num_nanoseconds>
+// Returns 0 on success, -1 on a bad option
+// -------------------------------
+int parseOptions(int argc, char **argv) {
+    for (int i = 3; i < argc; i++) {
+        const char *opt = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(opt, "--iterations") == 0 && val) {
+            sim_options.iterations = atoi(val);
+            if (sim_options.iterations <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --iterations must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--precision") == 0 && val) {
+            if (strcmp(val, "fp32") == 0) sim_options.precision = PRECISION_FP32;
+            else if (strcmp(val, "fp16") == 0) sim_options.precision = PRECISION_FP16;
+            else if (strcmp(val, "bf16") == 0) sim_options.precision = PRECISION_BF16;
+            else {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] Unknown precision mode: %s (expected fp32, fp16 or bf16)\n", rank, val);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--checkpoint") == 0 && val) {
+            sim_options.checkpoint_prefix = val;
+            i++;
+
+        } else if (strcmp(opt, "--checkpoint-every") == 0 && val) {
+            sim_options.checkpoint_every_ns = atoi(val);
+            if (sim_options.checkpoint_every_ns <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --checkpoint-every must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--restart") == 0 && val) {
+            sim_options.restart_prefix = val;
+            i++;
+
+        } else if (strcmp(opt, "--exchange") == 0 && val) {
+            if (strcmp(val, "p2p") == 0) sim_options.exchange = EXCHANGE_P2P;
+            else if (strcmp(val, "neighbor") == 0) sim_options.exchange = EXCHANGE_NEIGHBOR;
+            else if (strcmp(val, "rma") == 0) sim_options.exchange = EXCHANGE_RMA;
+            else {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] Unknown exchange mode: %s (expected p2p, neighbor or rma)\n", rank, val);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--rma-buffer") == 0 && val) {
+            sim_options.rma_buffer_kb = atoi(val);
+            if (sim_options.rma_buffer_kb <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --rma-buffer must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--async-lag") == 0 && val) {
+            sim_options.async_lag = atoi(val);
+            if (sim_options.async_lag < 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --async-lag must not be negative\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--loader-threads") == 0 && val) {
+            sim_options.loader_threads = atoi(val);
+            if (sim_options.loader_threads <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --loader-threads must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--replicas") == 0 && val) {
+            sim_options.replicas = atoi(val);
+            if (sim_options.replicas <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --replicas must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--seed") == 0 && val) {
+            char *tail;
+            sim_options.seed = strtoll(val, &tail, 10);
+            if (*tail || sim_options.seed < 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --seed must be a non-negative integer\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--threads") == 0 && val) {
+            sim_options.threads = atoi(val);
+            if (sim_options.threads <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --threads must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--reorder") == 0 && val) {
+            if (strcmp(val, "file") == 0) sim_options.reorder = ORDER_FILE;
+            else if (strcmp(val, "hilbert") == 0) sim_options.reorder = ORDER_HILBERT;
+            else if (strcmp(val, "rcm") == 0) sim_options.reorder = ORDER_RCM;
+            else {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] Unknown node order: %s (expected file, hilbert or rcm)\n", rank, val);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--edge-format") == 0 && val) {
+            if (strcmp(val, "full") == 0) sim_options.edge_format = EDGE_FULL;
+            else if (strcmp(val, "compact") == 0) sim_options.edge_format = EDGE_COMPACT;
+            else {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] Unknown edge format: %s (expected full or compact)\n", rank, val);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--huge-pages") == 0) {
+            sim_options.huge_pages = 1;
+
+        } else if (strcmp(opt, "--numa-bind") == 0) {
+            sim_options.numa_bind = 1;
+
+        } else if (strcmp(opt, "--numa-report") == 0) {
+            sim_options.numa_report = 1;
+
+        } else if (strcmp(opt, "--progress-thread") == 0) {
+            sim_options.progress_thread = 1;
+
+        } else if (strcmp(opt, "--rebalance-every") == 0 && val) {
+            sim_options.rebalance_every = atoi(val);
+            if (sim_options.rebalance_every <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --rebalance-every must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--rebalance-threshold") == 0 && val) {
+            sim_options.rebalance_threshold = atof(val);
+            if (sim_options.rebalance_threshold < 1.0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --rebalance-threshold must be at least 1.0\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--report") == 0 && val) {
+            sim_options.report_file = val;
+            i++;
+
+        } else if (strcmp(opt, "--report-format") == 0 && val) {
+            if (strcmp(val, "text") == 0) sim_options.report_format = REPORT_TEXT;
+            else if (strcmp(val, "binary") == 0) sim_options.report_format = REPORT_BINARY;
+            else if (strcmp(val, "fixed-text") == 0) sim_options.report_format = REPORT_FIXED_TEXT;
+            else {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] Unknown report format: %s (expected text, binary or fixed-text)\n", rank, val);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--stats-json") == 0 && val) {
+            sim_options.stats_json = val;
+            i++;
+
+        } else if (strcmp(opt, "--telemetry") == 0 && val) {
+            sim_options.telemetry_file = val;
+            i++;
+
+        } else if (strcmp(opt, "--telemetry-top") == 0 && val) {
+            sim_options.telemetry_top_k = atoi(val);
+            if (sim_options.telemetry_top_k <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --telemetry-top must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else if (strcmp(opt, "--trace") == 0 && val) {
+            sim_options.trace_file = val;
+            i++;
+
+        } else if (strcmp(opt, "--trace-events") == 0 && val) {
+            sim_options.trace_events = atoi(val);
+            if (sim_options.trace_events <= 0) {
+                if (rank == 0)
+                    fprintf(stderr, "[Rank %d] --trace-events must be positive\n", rank);
+                return -1;
+            }
+            i++;
+
+        } else {
+            if (rank == 0)
+                fprintf(stderr, "[Rank %d] Unknown or incomplete option: %s\n", rank, opt);
+            return -1;
+        }
+    }
+
+    // Iteration tags are read by the compute thread's receive path, and the
+    // other transports synchronise every iteration by construction
+    if (sim_options.async_lag >= 0 && sim_options.exchange != EXCHANGE_P2P) {
+        if (rank == 0)
+            fprintf(stderr, "[Rank %d] --async-lag requires --exchange p2p\n", rank);
+        return -1;
+    }
+    if (sim_options.async_lag >= 0 && sim_options.progress_thread) {
+        if (rank == 0)
+            fprintf(stderr, "[Rank %d] --progress-thread is ignored with --async-lag\n", rank);
+        sim_options.progress_thread = 0;
+    }
+
+    // Per-run files would be overwritten replica after replica
+    if (sim_options.replicas > 1 &&
+        (sim_options.checkpoint_prefix || sim_options.restart_prefix ||
+         sim_options.telemetry_file || sim_options.trace_file)) {
+        if (rank == 0)
+            fprintf(stderr, "[Rank %d] --replicas cannot be combined with --checkpoint, --restart, "
+                            "--telemetry or --trace\n", rank);
+        return -1;
+    }
+
+    // The neighbourhood collective and RMA epochs run on the compute thread
+    if (sim_options.exchange != EXCHANGE_P2P && sim_options.progress_thread) {
+        if (rank == 0)
+            fprintf(stderr, "[Rank %d] --progress-thread only applies to --exchange p2p\n", rank);
+        sim_options.progress_thread = 0;
+    }
+
+    return 0;
+}
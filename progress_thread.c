@@ -0,0 +1,244 @@
+// -------------------------------
+// progress_thread.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "brain.h"
+#include <mpi.h>
+
+// Optional communication thread (--progress-thread). It owns all signal
+// point-to-point traffic on a private communicator: it posts the batches
+// the compute thread hands over, completes them, and continuously pulls
+// incoming batches out of MPI and decodes them into a staging buffer.
+// The compute thread only swaps that buffer out at its receive points,
+// so inboxes are never touched from two threads and a rank crunching a
+// large inbox still drains the network behind it.
+
+#define TAG_SIGNAL 100
+#define IDLE_SLEEP_NS 20000
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+struct PendingSend {
+    int dest;
+    int len;
+    unsigned char *buf;
+    MPI_Request request;
+    struct PendingSend *next;
+};
+
+static pthread_t thread;
+static int running = 0;
+static MPI_Comm signal_comm = MPI_COMM_NULL;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int stop_requested = 0;                          // under lock
+static struct PendingSend *outbox_head = NULL, *outbox_tail = NULL;  // under lock
+static struct WireSignal *staged = NULL;                // under lock
+static int staged_count = 0, staged_capacity = 0;       // under lock
+static long long staged_batches = 0;                    // under lock
+
+// Thread-private
+static struct PendingSend *in_flight = NULL;
+static struct WireSignal *decoded = NULL;
+static int decoded_count = 0, decoded_capacity = 0;
+static unsigned char *recv_buffer = NULL;
+static int recv_capacity = 0;
+
+static void *growOrDie(void *p, size_t bytes) {
+    void *grown = realloc(p, bytes);
+    if (!grown) {
+        fprintf(stderr, "[Rank %d] Progress thread failed to allocate %zu bytes\n", rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return grown;
+}
+
+static void decodeOne(int local_idx, struct SignalStruct signal) {
+    if (decoded_count == decoded_capacity) {
+        decoded_capacity = decoded_capacity ? decoded_capacity * 2 : 1024;
+        decoded = growOrDie(decoded, decoded_capacity * sizeof(struct WireSignal));
+    }
+    decoded[decoded_count].local_idx = local_idx;
+    decoded[decoded_count].signal = signal;
+    decoded_count++;
+}
+
+// -------------------------------
+// Receive every batch that has arrived; returns how many
+// -------------------------------
+static int receiveBatches() {
+    int received = 0, flag, len;
+    MPI_Message message;
+    MPI_Status status;
+
+    while (1) {
+        MPI_Improbe(MPI_ANY_SOURCE, TAG_SIGNAL, signal_comm, &flag, &message, &status);
+        if (!flag)
+            break;
+
+        MPI_Get_count(&status, MPI_BYTE, &len);
+        if (len > recv_capacity) {
+            recv_buffer = growOrDie(recv_buffer, len);
+            recv_capacity = len;
+        }
+        MPI_Mrecv(recv_buffer, len, MPI_BYTE, &message, MPI_STATUS_IGNORE);
+
+        decoded_count = 0;
+        if (decodeSignalBatch(recv_buffer, (size_t)len, decodeOne) < 0)
+            fprintf(stderr, "[Rank %d]️ Malformed signal batch from rank %d (%d bytes)\n", rank, status.MPI_SOURCE, len);
+
+        // Publish the whole batch at once so the count and the signals agree
+        pthread_mutex_lock(&lock);
+        if (staged_count + decoded_count > staged_capacity) {
+            staged_capacity = (staged_count + decoded_count) * 2;
+            staged = growOrDie(staged, staged_capacity * sizeof(struct WireSignal));
+        }
+        memcpy(&staged[staged_count], decoded, decoded_count * sizeof(struct WireSignal));
+        staged_count += decoded_count;
+        staged_batches++;
+        pthread_mutex_unlock(&lock);
+        received++;
+    }
+    return received;
+}
+
+// -------------------------------
+// Post queued sends and retire completed ones; returns work done
+// -------------------------------
+static int progressSends(struct PendingSend *queued) {
+    int work = 0;
+    while (queued) {
+        struct PendingSend *send = queued;
+        queued = queued->next;
+        MPI_Isend(send->buf, send->len, MPI_BYTE, send->dest, TAG_SIGNAL, signal_comm, &send->request);
+        send->next = in_flight;
+        in_flight = send;
+        work++;
+    }
+
+    struct PendingSend **link = &in_flight;
+    while (*link) {
+        int done;
+        MPI_Test(&(*link)->request, &done, MPI_STATUS_IGNORE);
+        if (done) {
+            struct PendingSend *send = *link;
+            *link = send->next;
+            free(send->buf);
+            free(send);
+            work++;
+        } else {
+            link = &(*link)->next;
+        }
+    }
+    return work;
+}
+
+static void *progressMain(void *arg) {
+    (void)arg;
+    struct timespec idle = { 0, IDLE_SLEEP_NS };
+
+    for (;;) {
+        pthread_mutex_lock(&lock);
+        struct PendingSend *queued = outbox_head;
+        outbox_head = outbox_tail = NULL;
+        int stopping = stop_requested;
+        pthread_mutex_unlock(&lock);
+
+        int work = progressSends(queued) + receiveBatches();
+
+        // Exit only once our own sends have completed
+        if (stopping && !queued && !in_flight)
+            break;
+        if (!work)
+            nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+// -------------------------------
+// Collective: duplicate the communicator and start the thread
+// -------------------------------
+void startProgressThread() {
+    MPI_Comm_dup(MPI_COMM_WORLD, &signal_comm);
+    stop_requested = 0;
+    if (pthread_create(&thread, NULL, progressMain, NULL) != 0) {
+        fprintf(stderr, "[Rank %d] Failed to start progress thread\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    running = 1;
+}
+
+// -------------------------------
+// Hand an encoded batch to the thread; it frees buf once sent
+// -------------------------------
+void progressPostSend(int dest, unsigned char *buf, int len) {
+    struct PendingSend *send = malloc(sizeof(struct PendingSend));
+    if (!send) {
+        fprintf(stderr, "[Rank %d] Failed to queue batch for rank %d\n", rank, dest);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    send->dest = dest;
+    send->buf = buf;
+    send->len = len;
+    send->next = NULL;
+
+    pthread_mutex_lock(&lock);
+    if (outbox_tail)
+        outbox_tail->next = send;
+    else
+        outbox_head = send;
+    outbox_tail = send;
+    pthread_mutex_unlock(&lock);
+}
+
+// -------------------------------
+// Swap out everything received so far. *signals / *capacity are the
+// caller's buffer, exchanged for the staging one. Returns the number of
+// staged signals; *batches gets the cumulative batch count
+// -------------------------------
+int progressTakeSignals(struct WireSignal **signals, int *capacity, long long *batches) {
+    pthread_mutex_lock(&lock);
+    struct WireSignal *taken = staged;
+    int count = staged_count, taken_capacity = staged_capacity;
+    staged = *signals;
+    staged_capacity = *capacity;
+    staged_count = 0;
+    *batches = staged_batches;
+    pthread_mutex_unlock(&lock);
+
+    *signals = taken;
+    *capacity = taken_capacity;
+    return count;
+}
+
+// -------------------------------
+// Let the thread finish its sends, then join it. Call after the final
+// drain, before MPI_Finalize
+// -------------------------------
+void stopProgressThread() {
+    if (!running)
+        return;
+
+    pthread_mutex_lock(&lock);
+    stop_requested = 1;
+    pthread_mutex_unlock(&lock);
+    pthread_join(thread, NULL);
+    running = 0;
+
+    MPI_Comm_free(&signal_comm);
+    free(staged);
+    free(decoded);
+    free(recv_buffer);
+    staged = decoded = NULL;
+    recv_buffer = NULL;
+    staged_count = staged_capacity = decoded_count = decoded_capacity = recv_capacity = 0;
+    staged_batches = 0;
+}
@@ -0,0 +1,271 @@
+// -------------------------------
+// rebalance.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brain.h"
+#include <mpi.h>
+
+// Ownership stays a set of contiguous index ranges; rebalancing moves the
+// range boundaries. Each rank's node-update time over the last window is
+// spread over its nodes in proportion to the signals each one processed,
+// the boundaries are re-cut so every rank gets an equal share of that
+// estimated cost, and nodes that change owner are shipped (counters and
+// inbox) with one all-to-all. In-flight batches address nodes relative to
+// the owner's range start, so the exchange is drained first.
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+// Fixed part of a migrated node: index, total received, this ns, last ns,
+// inbox length, then nerve inputs and outputs. The inbox follows
+#define MIGRATE_FIELDS (5 + 2 * NUM_SIGNAL_TYPES)
+
+static double window_work = 0.0;   // update time at the start of the window
+static int *window_signals = NULL; // total_signals_recieved at the start of the window
+
+static double updateTime() {
+    return sim_stats.phase_time[PHASE_NERVE_UPDATE] + sim_stats.phase_time[PHASE_NEURON_UPDATE];
+}
+
+static void *allocOrDie(size_t bytes) {
+    void *p = malloc(bytes > 0 ? bytes : 1);
+    if (!p) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %zu bytes for rebalancing\n", rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return p;
+}
+
+static size_t nodeRecordSize(int idx) {
+    return MIGRATE_FIELDS * sizeof(int) + brain_nodes[idx].num_outstanding_signals * sizeof(struct SignalStruct);
+}
+
+static unsigned char *packNode(unsigned char *p, int idx) {
+    struct NeuronNerveStruct *node = &brain_nodes[idx];
+    int fields[5] = { idx, node->total_signals_recieved, node->signals_this_ns,
+                      node->signals_last_ns, node->num_outstanding_signals };
+    memcpy(p, fields, sizeof(fields));
+    p += sizeof(fields);
+    memcpy(p, node->num_nerve_inputs, NUM_SIGNAL_TYPES * sizeof(int));
+    p += NUM_SIGNAL_TYPES * sizeof(int);
+    memcpy(p, node->num_nerve_outputs, NUM_SIGNAL_TYPES * sizeof(int));
+    p += NUM_SIGNAL_TYPES * sizeof(int);
+    memcpy(p, node->signalInbox, node->num_outstanding_signals * sizeof(struct SignalStruct));
+    p += node->num_outstanding_signals * sizeof(struct SignalStruct);
+
+    // The inbox now lives with the new owner
+    node->num_outstanding_signals = 0;
+    return p;
+}
+
+static const unsigned char *unpackNode(const unsigned char *p) {
+    int fields[5];
+    memcpy(fields, p, sizeof(fields));
+    p += sizeof(fields);
+
+    int idx = fields[0], inbox = fields[4];
+    if (idx < 0 || idx >= num_brain_nodes || inbox < 0 || inbox > SIGNAL_INBOX_SIZE) {
+        fprintf(stderr, "[Rank %d] Corrupt migrated node record (index %d, inbox %d)\n", rank, idx, inbox);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    struct NeuronNerveStruct *node = &brain_nodes[idx];
+    node->total_signals_recieved = fields[1];
+    node->signals_this_ns = fields[2];
+    node->signals_last_ns = fields[3];
+    node->num_outstanding_signals = inbox;
+    memcpy(node->num_nerve_inputs, p, NUM_SIGNAL_TYPES * sizeof(int));
+    p += NUM_SIGNAL_TYPES * sizeof(int);
+    memcpy(node->num_nerve_outputs, p, NUM_SIGNAL_TYPES * sizeof(int));
+    p += NUM_SIGNAL_TYPES * sizeof(int);
+    memcpy(node->signalInbox, p, inbox * sizeof(struct SignalStruct));
+    p += inbox * sizeof(struct SignalStruct);
+
+    window_signals[idx] = node->total_signals_recieved;
+    return p;
+}
+
+static void startWindow(int start_idx, int end_idx) {
+    for (int i = start_idx; i < end_idx; i++)
+        window_signals[i] = brain_nodes[i].total_signals_recieved;
+    window_work = updateTime();
+}
+
+// -------------------------------
+// Start the first measurement window
+// -------------------------------
+void initRebalance(int start_idx, int end_idx) {
+    window_signals = allocOrDie(num_brain_nodes * sizeof(int));
+    startWindow(start_idx, end_idx);
+}
+
+void freeRebalance() {
+    free(window_signals);
+    window_signals = NULL;
+}
+
+// -------------------------------
+// Collective: measure the last window and, if the slowest rank is more
+// than `threshold` times the mean, move range boundaries and migrate
+// nodes. Updates *start_idx / *end_idx to the new owned range
+// -------------------------------
+void rebalanceNodes(int *start_idx, int *end_idx, int iteration, double threshold) {
+    double work = updateTime() - window_work;
+    double *rank_work = allocOrDie(size * sizeof(double));
+    MPI_Allgather(&work, 1, MPI_DOUBLE, rank_work, 1, MPI_DOUBLE, MPI_COMM_WORLD);
+
+    double max_work = 0.0, sum_work = 0.0;
+    for (int r = 0; r < size; r++) {
+        sum_work += rank_work[r];
+        if (rank_work[r] > max_work) max_work = rank_work[r];
+    }
+    double imbalance = sum_work > 0 ? max_work * size / sum_work : 1.0;
+    free(rank_work);
+
+    if (imbalance <= threshold) {
+        startWindow(*start_idx, *end_idx);
+        return;
+    }
+
+    phaseBegin(PHASE_REBALANCE);
+    double began = MPI_Wtime();
+
+    // Every batch must have landed in an inbox before ranges move
+    completeOutgoingSignals();
+
+    // --- Per-node cost estimate, gathered everywhere ---
+    int owned = *end_idx - *start_idx;
+    double *local_cost = allocOrDie(owned * sizeof(double));
+    double weight_sum = 0.0;
+    for (int i = 0; i < owned; i++) {
+        int idx = *start_idx + i;
+        local_cost[i] = 1.0 + (brain_nodes[idx].total_signals_recieved - window_signals[idx]);
+        weight_sum += local_cost[i];
+    }
+    for (int i = 0; i < owned; i++)
+        local_cost[i] *= work / weight_sum;
+
+    int *old_starts = allocOrDie((size + 1) * sizeof(int));
+    int *counts = allocOrDie(size * sizeof(int));
+    for (int r = 0; r <= size; r++)
+        old_starts[r] = getRankStartIndex(r);
+    for (int r = 0; r < size; r++)
+        counts[r] = old_starts[r + 1] - old_starts[r];
+
+    double *cost = allocOrDie(num_brain_nodes * sizeof(double));
+    MPI_Allgatherv(local_cost, owned, MPI_DOUBLE, cost, counts, old_starts, MPI_DOUBLE, MPI_COMM_WORLD);
+    free(local_cost);
+
+    // --- Cut the prefix sum into equal shares ---
+    int *new_starts = allocOrDie((size + 1) * sizeof(int));
+    double total = 0.0, acc = 0.0;
+    for (int i = 0; i < num_brain_nodes; i++)
+        total += cost[i];
+
+    // Boundary r goes before the first node whose midpoint passes r/size
+    // of the total cost
+    int r = 1;
+    for (int i = 0; i < num_brain_nodes && r < size; i++) {
+        while (r < size && acc + cost[i] / 2 > total * r / size)
+            new_starts[r++] = i;
+        acc += cost[i];
+    }
+    while (r < size)
+        new_starts[r++] = num_brain_nodes;
+    new_starts[0] = 0;
+    new_starts[size] = num_brain_nodes;
+
+    double predicted_max = 0.0;
+    for (int d = 0; d < size; d++) {
+        double part = 0.0;
+        for (int i = new_starts[d]; i < new_starts[d + 1]; i++)
+            part += cost[i];
+        if (part > predicted_max) predicted_max = part;
+    }
+    double predicted = total > 0 ? predicted_max * size / total : 1.0;
+    free(cost);
+
+    // --- Ship nodes whose owner changed ---
+    int *send_bytes = allocOrDie(size * sizeof(int));
+    int *recv_bytes = allocOrDie(size * sizeof(int));
+    int *send_displs = allocOrDie(size * sizeof(int));
+    int *recv_displs = allocOrDie(size * sizeof(int));
+    size_t send_total = 0;
+
+    for (int d = 0; d < size; d++) {
+        int lo = new_starts[d] > *start_idx ? new_starts[d] : *start_idx;
+        int hi = new_starts[d + 1] < *end_idx ? new_starts[d + 1] : *end_idx;
+        size_t bytes = 0;
+        if (d != rank)
+            for (int i = lo; i < hi; i++)
+                bytes += nodeRecordSize(i);
+        send_displs[d] = (int)send_total;
+        send_bytes[d] = (int)bytes;
+        send_total += bytes;
+    }
+
+    unsigned char *send_buf = allocOrDie(send_total);
+    for (int d = 0; d < size; d++) {
+        if (d == rank)
+            continue;
+        int lo = new_starts[d] > *start_idx ? new_starts[d] : *start_idx;
+        int hi = new_starts[d + 1] < *end_idx ? new_starts[d + 1] : *end_idx;
+        unsigned char *p = send_buf + send_displs[d];
+        for (int i = lo; i < hi; i++)
+            p = packNode(p, i);
+    }
+
+    MPI_Alltoall(send_bytes, 1, MPI_INT, recv_bytes, 1, MPI_INT, MPI_COMM_WORLD);
+    size_t recv_total = 0;
+    for (int s = 0; s < size; s++) {
+        recv_displs[s] = (int)recv_total;
+        recv_total += recv_bytes[s];
+    }
+
+    unsigned char *recv_buf = allocOrDie(recv_total);
+    MPI_Alltoallv(send_buf, send_bytes, send_displs, MPI_BYTE,
+                  recv_buf, recv_bytes, recv_displs, MPI_BYTE, MPI_COMM_WORLD);
+
+    long long received_nodes = 0;
+    const unsigned char *p = recv_buf;
+    while (p < recv_buf + recv_total) {
+        p = unpackNode(p);
+        received_nodes++;
+    }
+
+    setPartition(new_starts);
+    *start_idx = new_starts[rank];
+    *end_idx = new_starts[rank + 1];
+    if (sim_options.telemetry_file)
+        telemetrySetRange(*start_idx, *end_idx);
+
+    sim_stats.counters[STAT_NODES_MIGRATED] += received_nodes;
+
+    long long moved[2] = { received_nodes, (long long)send_total }, moved_sum[2];
+    MPI_Reduce(moved, moved_sum, 2, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    double elapsed = MPI_Wtime() - began, max_elapsed;
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank == 0)
+        printf("[Rank 0] Rebalanced at iteration %d: imbalance %.2f -> %.2f (estimated), "
+               "moved %lld nodes (%lld bytes) in %.3f ms\n",
+               iteration, imbalance, predicted, moved_sum[0], moved_sum[1], max_elapsed * 1000.0);
+
+    free(old_starts);
+    free(counts);
+    free(new_starts);
+    free(send_bytes);
+    free(recv_bytes);
+    free(send_displs);
+    free(recv_displs);
+    free(send_buf);
+    free(recv_buf);
+    phaseEnd(PHASE_REBALANCE);
+
+    startWindow(*start_idx, *end_idx);
+}
@@ -0,0 +1,31 @@
+#ifndef REPORT_FORMAT_H
+#define REPORT_FORMAT_H
+
+#include <stdint.h>
+
+// -------------------------------
+// Binary report layout, shared by the MPI-IO writer and brain_report.
+// A header followed by one fixed-size record per node in graph file
+// order, so each rank writes its nodes at computed offsets
+// -------------------------------
+#define REPORT_MAGIC 0x54525042u   // "BPRT"
+#define REPORT_VERSION 1
+#define REPORT_SIGNAL_TYPES 10
+
+struct ReportHeader {
+    uint32_t magic, version;
+    int32_t num_neurons, num_nerves, num_edges;
+    int32_t elapsed_ns;
+    int32_t num_brain_nodes;
+    int32_t num_signal_types;
+};
+
+struct ReportRecord {
+    int32_t id;
+    int32_t node_type;   // enum NodeType
+    int32_t total_signals_received;
+    int32_t nerve_inputs[REPORT_SIGNAL_TYPES];
+    int32_t nerve_outputs[REPORT_SIGNAL_TYPES];
+};
+
+#endif // REPORT_FORMAT_H
@@ -0,0 +1,205 @@
+// -------------------------------
+// report_io.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brain.h"
+#include "report_format.h"
+#include <mpi.h>
+
+#if REPORT_SIGNAL_TYPES != NUM_SIGNAL_TYPES
+#error "report_format.h is out of step with NUM_SIGNAL_TYPES"
+#endif
+
+// Fixed-width variants of the generateReport lines. Every count is padded
+// to 10 digits so each nerve and neuron entry has a known size and every
+// rank can compute where its nodes go without talking to the others
+#define FIXED_NERVE_HEADER "Nerve %10d (ID: %10d)\n"
+#define FIXED_NERVE_TYPE   "----> Type %d: %10d inputs, %10d outputs\n"
+#define FIXED_NEURON_LINE  "Neuron %10d (ID: %10d), total signals received: %10d\n"
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+static void openShared(const char *filename, MPI_File *fh) {
+    int err = MPI_File_open(MPI_COMM_WORLD, filename, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, fh);
+    if (err != MPI_SUCCESS) {
+        fprintf(stderr, "[Rank %d] Failed to open report file: %s\n", rank, filename);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_File_set_size(*fh, 0);
+}
+
+static void *allocOrDie(size_t bytes) {
+    void *p = malloc(bytes > 0 ? bytes : 1);
+    if (!p) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %zu bytes for report output\n", rank, bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return p;
+}
+
+// Where one owned node's entry goes in the file
+struct ReportSlot {
+    MPI_Aint offset;
+    int idx;
+};
+
+static int compareSlots(const void *a, const void *b) {
+    MPI_Aint x = ((const struct ReportSlot *)a)->offset, y = ((const struct ReportSlot *)b)->offset;
+    return (x > y) - (x < y);
+}
+
+// -------------------------------
+// Binary report: header + one ReportRecord per node, in graph file order.
+// Without reordering our records are one contiguous run; with it they
+// are scattered, so each rank writes through an indexed file view
+// -------------------------------
+static void writeBinaryReport(const char *filename, int start_idx, int end_idx) {
+    MPI_File fh;
+    openShared(filename, &fh);
+
+    if (rank == 0) {
+        struct ReportHeader header = {
+            .magic = REPORT_MAGIC, .version = REPORT_VERSION,
+            .num_neurons = num_neurons, .num_nerves = num_nerves, .num_edges = num_edges,
+            .elapsed_ns = elapsed_ns, .num_brain_nodes = num_brain_nodes,
+            .num_signal_types = NUM_SIGNAL_TYPES,
+        };
+        MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+
+    int count = end_idx - start_idx;
+    struct ReportSlot *slots = allocOrDie(count * sizeof(struct ReportSlot));
+    for (int i = 0; i < count; i++) {
+        slots[i].offset = getNodeFilePosition(start_idx + i);
+        slots[i].idx = start_idx + i;
+    }
+    qsort(slots, count, sizeof(struct ReportSlot), compareSlots);
+
+    struct ReportRecord *records = allocOrDie(count * sizeof(struct ReportRecord));
+    int *positions = allocOrDie(count * sizeof(int));
+    for (int i = 0; i < count; i++) {
+        struct NeuronNerveStruct *node = &brain_nodes[slots[i].idx];
+        positions[i] = (int)slots[i].offset;
+        records[i].id = node->id;
+        records[i].node_type = node->node_type;
+        records[i].total_signals_received = node->total_signals_recieved;
+        memcpy(records[i].nerve_inputs, node->num_nerve_inputs, NUM_SIGNAL_TYPES * sizeof(int));
+        memcpy(records[i].nerve_outputs, node->num_nerve_outputs, NUM_SIGNAL_TYPES * sizeof(int));
+    }
+
+    MPI_Datatype record_type, file_type;
+    MPI_Type_contiguous(sizeof(struct ReportRecord), MPI_BYTE, &record_type);
+    MPI_Type_commit(&record_type);
+    MPI_Type_create_indexed_block(count, 1, positions, record_type, &file_type);
+    MPI_Type_commit(&file_type);
+
+    MPI_File_set_view(fh, sizeof(struct ReportHeader), record_type, file_type, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, records, count, record_type, MPI_STATUS_IGNORE);
+
+    MPI_Type_free(&file_type);
+    MPI_Type_free(&record_type);
+    MPI_File_close(&fh);
+    free(slots);
+    free(records);
+    free(positions);
+}
+
+// -------------------------------
+// Text report in the generateReport layout with fixed-width numbers.
+// Every entry has a known size and nerves and neurons are numbered in
+// graph file order, so each rank can compute where its entries go and
+// write them all through one indexed file view
+// -------------------------------
+static void writeFixedTextReport(const char *filename, int start_idx, int end_idx) {
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "Simulation ran with %d neurons, %d nerves and %d total edges until %d ns\n\n",
+                              num_neurons, num_nerves, num_edges, elapsed_ns);
+
+    // Entry sizes from a zero-valued sample
+    char line[128];
+    int nerve_len = snprintf(line, sizeof(line), FIXED_NERVE_HEADER, 0, 0);
+    for (int j = 0; j < NUM_SIGNAL_TYPES; j++)
+        nerve_len += snprintf(line, sizeof(line), FIXED_NERVE_TYPE, j, 0, 0);
+    int neuron_len = snprintf(line, sizeof(line), FIXED_NEURON_LINE, 0, 0, 0);
+
+    MPI_Offset nerve_base = header_len;
+    MPI_Offset neuron_base = nerve_base + (MPI_Offset)num_nerves * nerve_len + 1;
+
+    // Nerve and neuron ordinals follow the file
+    int *ordinal = allocOrDie(num_brain_nodes * sizeof(int));
+    int nerves = 0, neurons = 0;
+    for (int p = 0; p < num_brain_nodes; p++) {
+        int i = getNodeAtFilePosition(p);
+        ordinal[i] = (brain_nodes[i].node_type == NERVE) ? nerves++ : neurons++;
+    }
+
+    int count = end_idx - start_idx;
+    struct ReportSlot *slots = allocOrDie(count * sizeof(struct ReportSlot));
+    size_t bytes = 0;
+    for (int i = 0; i < count; i++) {
+        int idx = start_idx + i, is_nerve = (brain_nodes[idx].node_type == NERVE);
+        slots[i].idx = idx;
+        slots[i].offset = (MPI_Aint)(is_nerve ? nerve_base + (MPI_Offset)ordinal[idx] * nerve_len
+                                              : neuron_base + (MPI_Offset)ordinal[idx] * neuron_len);
+        bytes += is_nerve ? nerve_len : neuron_len;
+    }
+    qsort(slots, count, sizeof(struct ReportSlot), compareSlots);
+
+    // +1 for the terminating NUL of the last sprintf
+    char *text = allocOrDie(bytes + 1);
+    int *lengths = allocOrDie(count * sizeof(int));
+    MPI_Aint *offsets = allocOrDie(count * sizeof(MPI_Aint));
+    char *tp = text;
+    for (int i = 0; i < count; i++) {
+        struct NeuronNerveStruct *node = &brain_nodes[slots[i].idx];
+        char *entry = tp;
+        if (node->node_type == NERVE) {
+            tp += sprintf(tp, FIXED_NERVE_HEADER, ordinal[slots[i].idx], node->id);
+            for (int j = 0; j < NUM_SIGNAL_TYPES; j++)
+                tp += sprintf(tp, FIXED_NERVE_TYPE, j, node->num_nerve_inputs[j], node->num_nerve_outputs[j]);
+        } else {
+            tp += sprintf(tp, FIXED_NEURON_LINE, ordinal[slots[i].idx], node->id, node->total_signals_recieved);
+        }
+        lengths[i] = (int)(tp - entry);
+        offsets[i] = slots[i].offset;
+    }
+
+    MPI_File fh;
+    openShared(filename, &fh);
+
+    if (rank == 0) {
+        MPI_File_write_at(fh, 0, header, header_len, MPI_CHAR, MPI_STATUS_IGNORE);
+        MPI_File_write_at(fh, neuron_base - 1, "\n", 1, MPI_CHAR, MPI_STATUS_IGNORE);
+    }
+
+    MPI_Datatype file_type;
+    MPI_Type_create_hindexed(count, lengths, offsets, MPI_CHAR, &file_type);
+    MPI_Type_commit(&file_type);
+    MPI_File_set_view(fh, 0, MPI_CHAR, file_type, "native", MPI_INFO_NULL);
+    MPI_File_write_all(fh, text, (int)(tp - text), MPI_CHAR, MPI_STATUS_IGNORE);
+
+    MPI_Type_free(&file_type);
+    MPI_File_close(&fh);
+    free(ordinal);
+    free(slots);
+    free(text);
+    free(lengths);
+    free(offsets);
+}
+
+// -------------------------------
+// Collective report writer: every rank writes the nodes it owns
+// -------------------------------
+void writeParallelReport(const char *filename, enum ReportFormat format, int start_idx, int end_idx) {
+    if (format == REPORT_BINARY)
+        writeBinaryReport(filename, start_idx, end_idx);
+    else
+        writeFixedTextReport(filename, start_idx, end_idx);
+}
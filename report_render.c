@@ -0,0 +1,78 @@
+// -------------------------------
+// report_render.c
+// Render a binary report as the text summary
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "report_format.h"
+
+#define NODE_TYPE_NERVE 1   // enum NodeType in brain.h
+
+// Reads every record for each section in turn, so memory stays constant
+// however large the report is
+static int readRecord(FILE *in, long idx, struct ReportRecord *rec) {
+    if (fseek(in, (long)sizeof(struct ReportHeader) + idx * (long)sizeof(struct ReportRecord), SEEK_SET) != 0)
+        return 0;
+    return fread(rec, sizeof(*rec), 1, in) == 1;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <binary_report> [text_output]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in = fopen(argv[1], "rb");
+    if (!in) {
+        fprintf(stderr, "Could not open report %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    struct ReportHeader header;
+    if (fread(&header, sizeof(header), 1, in) != 1 ||
+        header.magic != REPORT_MAGIC || header.version != REPORT_VERSION ||
+        header.num_signal_types != REPORT_SIGNAL_TYPES) {
+        fprintf(stderr, "%s is not a version %d binary report\n", argv[1], REPORT_VERSION);
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Could not open output %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(out, "Simulation ran with %d neurons, %d nerves and %d total edges until %d ns\n\n",
+            header.num_neurons, header.num_nerves, header.num_edges, header.elapsed_ns);
+
+    struct ReportRecord rec;
+    int nerve_count = 0;
+    for (long i = 0; i < header.num_brain_nodes; i++) {
+        if (!readRecord(in, i, &rec)) {
+            fprintf(stderr, "Truncated report at node %ld\n", i);
+            return EXIT_FAILURE;
+        }
+        if (rec.node_type != NODE_TYPE_NERVE)
+            continue;
+        fprintf(out, "Nerve %d (ID: %d)\n", nerve_count++, rec.id);
+        for (int j = 0; j < REPORT_SIGNAL_TYPES; j++)
+            fprintf(out, "----> Type %d: %d inputs, %d outputs\n", j, rec.nerve_inputs[j], rec.nerve_outputs[j]);
+    }
+
+    fprintf(out, "\n");
+    int neuron_count = 0;
+    for (long i = 0; i < header.num_brain_nodes; i++) {
+        if (!readRecord(in, i, &rec))
+            return EXIT_FAILURE;
+        if (rec.node_type == NODE_TYPE_NERVE)
+            continue;
+        fprintf(out, "Neuron %d (ID: %d), total signals received: %d\n",
+                neuron_count++, rec.id, rec.total_signals_received);
+    }
+
+    fclose(in);
+    if (out != stdout)
+        fclose(out);
+    return EXIT_SUCCESS;
+}
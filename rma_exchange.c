@@ -0,0 +1,126 @@
+// -------------------------------
+// rma_exchange.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brain.h"
+#include <mpi.h>
+
+// One-sided transport (--exchange rma). Every rank exposes a window:
+//
+//   [ used[0] | used[1] | area 0 (capacity bytes) | area 1 (capacity bytes) ]
+//
+// Senders reserve space in the target's area for the current epoch with
+// MPI_Fetch_and_op on used[parity] and MPI_Put a length-prefixed batch
+// there. All ranks hold a lock_all epoch for the whole run; puts are
+// flushed at the end of the send phase and the end-of-iteration
+// collective closes the epoch, after which each rank reads and clears
+// its own area. Areas alternate by epoch parity, so a fast rank already
+// writing epoch e+1 never touches the area still being read for epoch e.
+// Areas start zeroed and are re-zeroed after reading; a zero length
+// marks where valid records end, so a reservation that did not fit
+// (and was never written) stops the reader. Such batches go two-sided.
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+static MPI_Win window = MPI_WIN_NULL;
+static unsigned char *base = NULL;
+static MPI_Aint capacity = 0;
+static long long epoch = 0;
+
+static MPI_Aint counterDisp(int parity) {
+    return (MPI_Aint)(parity * sizeof(long long));
+}
+
+static MPI_Aint areaDisp(int parity) {
+    return (MPI_Aint)(2 * sizeof(long long)) + parity * capacity;
+}
+
+// -------------------------------
+// Collective: allocate and open the window
+// -------------------------------
+void initRmaExchange(size_t area_bytes) {
+    capacity = (MPI_Aint)area_bytes;
+    MPI_Aint bytes = areaDisp(2);
+
+    if (MPI_Win_allocate(bytes, 1, MPI_INFO_NULL, MPI_COMM_WORLD, &base, &window) != MPI_SUCCESS) {
+        fprintf(stderr, "[Rank %d] Failed to allocate %ld byte RMA window\n", rank, (long)bytes);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    memset(base, 0, bytes);
+    epoch = 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window);
+}
+
+// -------------------------------
+// Put one encoded batch into dest's area. `record` must have
+// RMA_RECORD_HEADER bytes free in front of the `len` payload bytes and stay
+// untouched until rmaCompleteSends. Returns 0 if the area is full
+// -------------------------------
+int rmaPostBatch(int dest, unsigned char *record, int len) {
+    int parity = (int)(epoch & 1);
+    long long reserve = (long long)(RMA_RECORD_HEADER + len), offset;
+
+    MPI_Fetch_and_op(&reserve, &offset, MPI_LONG_LONG, dest, counterDisp(parity), MPI_SUM, window);
+    MPI_Win_flush(dest, window);
+    if (offset + reserve > capacity)
+        return 0;
+
+    uint32_t header = (uint32_t)len;
+    memcpy(record, &header, RMA_RECORD_HEADER);
+    MPI_Put(record, (int)reserve, MPI_BYTE, dest, areaDisp(parity) + (MPI_Aint)offset,
+            (int)reserve, MPI_BYTE, window);
+    return 1;
+}
+
+// -------------------------------
+// Complete every put issued this epoch at its target
+// -------------------------------
+void rmaCompleteSends() {
+    MPI_Win_flush_all(window);
+}
+
+// -------------------------------
+// Read and clear our area for the epoch that just closed. Must follow a
+// collective that every sender entered after rmaCompleteSends
+// -------------------------------
+void rmaDrainEpoch(void (*deliver)(int local_idx, struct SignalStruct signal)) {
+    int parity = (int)(epoch & 1);
+    long long zero = 0, used;
+
+    MPI_Win_sync(window);
+    MPI_Fetch_and_op(&zero, &used, MPI_LONG_LONG, rank, counterDisp(parity), MPI_REPLACE, window);
+    MPI_Win_flush(rank, window);
+
+    unsigned char *area = base + areaDisp(parity);
+    MPI_Aint limit = used < capacity ? (MPI_Aint)used : capacity;
+    MPI_Aint pos = 0;
+    while (pos + (MPI_Aint)RMA_RECORD_HEADER <= limit) {
+        uint32_t len;
+        memcpy(&len, area + pos, RMA_RECORD_HEADER);
+        if (len == 0 || pos + (MPI_Aint)RMA_RECORD_HEADER + len > limit)
+            break;
+        if (decodeSignalBatch(area + pos + RMA_RECORD_HEADER, len, deliver) < 0)
+            fprintf(stderr, "[Rank %d]️ Malformed RMA signal batch (%u bytes)\n", rank, len);
+        pos += RMA_RECORD_HEADER + len;
+    }
+
+    memset(area, 0, limit);
+    MPI_Win_sync(window);
+    epoch++;
+}
+
+void freeRmaExchange() {
+    if (window == MPI_WIN_NULL)
+        return;
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+    base = NULL;
+}
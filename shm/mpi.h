@@ -0,0 +1,56 @@
+// -------------------------------
+// shm/mpi.h
+// -------------------------------
+//
+// Single-process stand-in for <mpi.h>, found first on the include path of
+// the shared-memory engine (brain_shm) build. It covers only what the
+// modules that engine shares with the MPI build use: a world of one rank,
+// so broadcasts are no-ops, reductions copy and abort exits.
+
+#ifndef SHM_MPI_H
+#define SHM_MPI_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef int MPI_Comm;
+typedef int MPI_Datatype;   // element size in bytes
+typedef int MPI_Op;
+
+#define MPI_SUCCESS 0
+#define MPI_COMM_WORLD 0
+
+#define MPI_INT ((MPI_Datatype)sizeof(int))
+#define MPI_FLOAT ((MPI_Datatype)sizeof(float))
+#define MPI_DOUBLE ((MPI_Datatype)sizeof(double))
+#define MPI_LONG_LONG ((MPI_Datatype)sizeof(long long))
+
+#define MPI_MIN 1
+#define MPI_MAX 2
+#define MPI_SUM 3
+
+static inline double MPI_Wtime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static inline int MPI_Abort(MPI_Comm comm, int code) {
+    (void)comm;
+    exit(code);
+}
+
+static inline int MPI_Bcast(void *buf, int count, MPI_Datatype type, int root, MPI_Comm comm) {
+    (void)buf; (void)count; (void)type; (void)root; (void)comm;
+    return MPI_SUCCESS;
+}
+
+static inline int MPI_Reduce(const void *in, void *out, int count, MPI_Datatype type,
+                             MPI_Op op, int root, MPI_Comm comm) {
+    (void)op; (void)root; (void)comm;
+    memmove(out, in, (size_t)count * type);
+    return MPI_SUCCESS;
+}
+
+#endif // SHM_MPI_H
@@ -0,0 +1,469 @@
+// -------------------------------
+// shm_engine.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "brain.h"
+
+// Shared-memory engine (brain_shm). Runs the same graph, node and signal
+// modules as brain_serial in one process with no MPI: shm/mpi.h stands
+// in for the few MPI calls those modules make. Worker threads take the
+// place of ranks. Each owns a contiguous node range, delivers signals
+// inside it straight into the inbox and stages the rest per destination
+// worker. Staging alternates by iteration parity, so a worker drains
+// what its peers staged last iteration while they fill the other half,
+// and a single barrier per iteration keeps the two apart. Random streams,
+// statistics and the node array are per worker (WORKER_LOCAL in brain.h).
+//
+// An ensemble (--replicas) splits the threads into groups, one replica
+// per group. Each group has its own copy of the node state over the
+// shared edges; with more replicas than threads they run in waves, the
+// next wave reusing the copies once they are reset.
+
+#define MAX_WORKERS 256
+
+// Global brain data; each worker points brain_nodes at its replica's
+WORKER_LOCAL struct NeuronNerveStruct *brain_nodes = NULL;
+struct EdgeStruct *edges = NULL;
+int num_neurons = 0, num_nerves = 0, num_edges = 0, num_brain_nodes = 0, elapsed_ns = 0;
+
+// The shared modules see a world of one rank
+int rank = 0, size = 1;
+
+// Signals staged for one destination worker; local_idx holds the
+// dense node index
+struct Outbox {
+    struct WireSignal *signals;
+    int count, capacity;
+};
+
+struct Group;
+
+struct Worker {
+    pthread_t thread;
+    struct Group *group;
+    int id;                         // within the group
+    int start_idx, end_idx;
+    struct Outbox *outbox[2];       // [iteration parity][destination worker]
+    struct SimStats stats;          // copied out when the worker finishes
+};
+
+// The workers running one replica
+struct Group {
+    int replica;
+    struct NeuronNerveStruct *nodes;
+    struct Worker *workers;
+    int num_workers;
+    int *worker_starts;             // num_workers + 1 entries
+    pthread_barrier_t step_barrier;
+    int ns_tick[2];                 // worker 0's rollover decision, by iteration parity
+
+    // Loop results, kept by worker 0
+    int total_iterations, elapsed_ns;
+    int max_iteration_per_ns, min_iteration_per_ns;
+};
+
+static struct Group *groups = NULL;
+static int num_groups = 0;
+static int num_ns_to_simulate;
+
+static __thread struct Worker *self;
+static __thread int parity;
+
+static int getOwnerWorker(const struct Group *group, int idx) {
+    if (idx < 0 || idx >= num_brain_nodes)
+        return -1;
+    int lo = 0, hi = group->num_workers - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (group->worker_starts[mid] <= idx) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+// -------------------------------
+// Append a signal to a node's inbox, or count it as dropped
+// -------------------------------
+void deliverSignal(int idx, struct SignalStruct signal) {
+    struct NeuronNerveStruct *node = &brain_nodes[idx];
+    if (node->num_outstanding_signals < SIGNAL_INBOX_SIZE) {
+        node->signalInbox[node->num_outstanding_signals++] = signal;
+    } else {
+        sim_stats.counters[STAT_INBOX_DROPS]++;
+        printf("[Thread %d] Signal dropped (inbox full): node %d\n", self->id, node->id);
+    }
+}
+
+// -------------------------------
+// Route a signal: own nodes take it now, other workers' next iteration
+// -------------------------------
+void sendSignalToRank(int tgt_idx, struct SignalStruct signal, int sender_rank, int world_size) {
+    (void)sender_rank;
+    (void)world_size;
+
+    if (tgt_idx >= self->start_idx && tgt_idx < self->end_idx) {
+        sim_stats.counters[STAT_CHUNKS_LOCAL]++;
+        deliverSignal(tgt_idx, signal);
+        return;
+    }
+
+    int owner = getOwnerWorker(self->group, tgt_idx);
+    if (owner == -1) {
+        fprintf(stderr, "[Thread %d] Could not determine owner thread for index %d\n", self->id, tgt_idx);
+        return;
+    }
+
+    struct Outbox *box = &self->outbox[parity][owner];
+    if (box->count == box->capacity) {
+        int new_capacity = box->capacity ? box->capacity * 2 : 256;
+        struct WireSignal *grown = realloc(box->signals, new_capacity * sizeof(struct WireSignal));
+        if (!grown) {
+            fprintf(stderr, "[Thread %d] realloc failed for outbox to thread %d\n", self->id, owner);
+            exit(EXIT_FAILURE);
+        }
+        box->signals = grown;
+        box->capacity = new_capacity;
+    }
+    box->signals[box->count].local_idx = tgt_idx;
+    box->signals[box->count].signal = signal;
+    box->count++;
+    sim_stats.counters[STAT_CHUNKS_REMOTE]++;
+}
+
+// Deliver what every worker staged for us in the previous iteration
+static void receiveStagedSignals() {
+    const struct Group *group = self->group;
+    int staged = parity ^ 1;
+    for (int w = 0; w < group->num_workers; w++) {
+        struct Outbox *box = &group->workers[w].outbox[staged][self->id];
+        for (int i = 0; i < box->count; i++)
+            deliverSignal(box->signals[i].local_idx, box->signals[i].signal);
+        box->count = 0;
+    }
+}
+
+// -------------------------------
+// One worker: the MPI main loop over its own node range
+// -------------------------------
+static void *runWorker(void *arg) {
+    self = arg;
+    struct Group *group = self->group;
+    brain_nodes = group->nodes;
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    seedRandom(getReplicaSeed(group->replica) + self->id);
+
+    int iterations = 0, current_ns_iterations = 0, ns = 0, tick = 0;
+    time_t seconds = 0, start_seconds = getCurrentSeconds();
+    double start_time = MPI_Wtime();
+
+    while (sim_options.iterations > 0 ? iterations < sim_options.iterations
+                                      : ns < num_ns_to_simulate) {
+        parity = iterations & 1;
+
+        if (tick) {
+            phaseBegin(PHASE_NS_ROLLOVER);
+            if (self->id == 0) {
+                if (ns == 0) {
+                    group->max_iteration_per_ns = group->min_iteration_per_ns = current_ns_iterations;
+                } else {
+                    if (current_ns_iterations > group->max_iteration_per_ns)
+                        group->max_iteration_per_ns = current_ns_iterations;
+                    if (current_ns_iterations < group->min_iteration_per_ns)
+                        group->min_iteration_per_ns = current_ns_iterations;
+                }
+            }
+            ns++;
+            current_ns_iterations = 0;
+
+            for (int i = self->start_idx; i < self->end_idx; i++) {
+                brain_nodes[i].signals_last_ns = brain_nodes[i].signals_this_ns;
+                brain_nodes[i].signals_this_ns = 0;
+            }
+            phaseEnd(PHASE_NS_ROLLOVER);
+        }
+
+        phaseBegin(PHASE_RECEIVE);
+        receiveStagedSignals();
+        phaseEnd(PHASE_RECEIVE);
+
+        phaseBegin(PHASE_NERVE_UPDATE);
+        for (int i = self->start_idx; i < self->end_idx; i++) {
+            if (brain_nodes[i].node_type == NERVE)
+                updateNodes(i);
+        }
+        phaseEnd(PHASE_NERVE_UPDATE);
+
+        phaseBegin(PHASE_NEURON_UPDATE);
+        for (int i = self->start_idx; i < self->end_idx; i++) {
+            if (brain_nodes[i].node_type == NEURON)
+                updateNodes(i);
+        }
+        phaseEnd(PHASE_NEURON_UPDATE);
+
+        if (self->id == 0) {
+            int local_tick = 0;
+            time_t current_seconds = getCurrentSeconds();
+            if (current_seconds != seconds) {
+                seconds = current_seconds;
+                local_tick = ((seconds - start_seconds) % MIN_LENGTH_NS == 0);
+            }
+            group->ns_tick[parity] = local_tick;
+        }
+
+        // Nobody reads this iteration's staging or tick before everyone
+        // has written them, and nobody rewrites them before the next
+        // barrier, by which time they have been read
+        phaseBegin(PHASE_BARRIER);
+        pthread_barrier_wait(&group->step_barrier);
+        phaseEnd(PHASE_BARRIER);
+
+        tick = group->ns_tick[parity];
+        current_ns_iterations++;
+        iterations++;
+    }
+
+    sim_stats.run_time = MPI_Wtime() - start_time;
+    sim_stats.iterations = iterations;
+
+    // Signals staged in the last iteration still belong in the inboxes
+    phaseBegin(PHASE_DRAIN);
+    parity = iterations & 1;
+    receiveStagedSignals();
+    phaseEnd(PHASE_DRAIN);
+
+    if (self->id == 0) {
+        group->elapsed_ns = ns;
+        group->total_iterations = iterations;
+    }
+    self->stats = sim_stats;
+    return NULL;
+}
+
+// Options that only mean something to the MPI engine
+static void ignoreMpiOptions() {
+    struct { int set; const char *name; } mpi_only[] = {
+        { sim_options.checkpoint_prefix != NULL, "--checkpoint" },
+        { sim_options.restart_prefix != NULL, "--restart" },
+        { sim_options.exchange != EXCHANGE_P2P, "--exchange" },
+        { sim_options.async_lag >= 0, "--async-lag" },
+        { sim_options.progress_thread, "--progress-thread" },
+        { sim_options.rebalance_every > 0, "--rebalance-every" },
+        { sim_options.numa_bind, "--numa-bind" },
+        { sim_options.numa_report, "--numa-report" },
+        { sim_options.telemetry_file != NULL, "--telemetry" },
+        { sim_options.trace_file != NULL, "--trace" },
+        { sim_options.report_format != REPORT_TEXT, "--report-format" },
+    };
+    for (size_t i = 0; i < sizeof(mpi_only) / sizeof(mpi_only[0]); i++)
+        if (mpi_only[i].set)
+            fprintf(stderr, "[Rank 0] %s applies to the MPI engine only, ignoring\n", mpi_only[i].name);
+    sim_options.trace_file = NULL;
+}
+
+// Fold a group's worker statistics into sim_stats for reportStats:
+// counters add up, phase and run times take the slowest worker
+static void mergeWorkerStats(const struct Group *group, long long *min_processed, long long *max_processed) {
+    memset(&sim_stats, 0, sizeof(sim_stats));
+    for (int w = 0; w < group->num_workers; w++) {
+        const struct SimStats *s = &group->workers[w].stats;
+        for (int p = 0; p < NUM_PHASES; p++)
+            if (s->phase_time[p] > sim_stats.phase_time[p])
+                sim_stats.phase_time[p] = s->phase_time[p];
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            if (c == STAT_PEAK_INBOX) {
+                if (s->counters[c] > sim_stats.counters[c])
+                    sim_stats.counters[c] = s->counters[c];
+            } else {
+                sim_stats.counters[c] += s->counters[c];
+            }
+        }
+        if (s->run_time > sim_stats.run_time)
+            sim_stats.run_time = s->run_time;
+
+        long long processed = s->counters[STAT_SIGNALS_PROCESSED];
+        if (w == 0 || processed < *min_processed) *min_processed = processed;
+        if (w == 0 || processed > *max_processed) *max_processed = processed;
+    }
+    sim_stats.iterations = group->total_iterations;
+}
+
+// Split nodes over a group's workers like initPartition splits them over ranks
+static void initGroup(struct Group *group, int num_workers, struct NeuronNerveStruct *nodes) {
+    group->nodes = nodes;
+    group->num_workers = num_workers;
+    group->workers = calloc(num_workers, sizeof(struct Worker));
+    group->worker_starts = malloc((num_workers + 1) * sizeof(int));
+    if (!group->workers || !group->worker_starts) {
+        fprintf(stderr, "[Rank 0] Failed to allocate %d workers\n", num_workers);
+        exit(EXIT_FAILURE);
+    }
+
+    int base = num_brain_nodes / num_workers, extra = num_brain_nodes % num_workers;
+    for (int w = 0; w <= num_workers; w++)
+        group->worker_starts[w] = w * base + (w < extra ? w : extra);
+
+    for (int w = 0; w < num_workers; w++) {
+        struct Worker *worker = &group->workers[w];
+        worker->group = group;
+        worker->id = w;
+        worker->start_idx = group->worker_starts[w];
+        worker->end_idx = group->worker_starts[w + 1];
+        for (int p = 0; p < 2; p++) {
+            worker->outbox[p] = calloc(num_workers, sizeof(struct Outbox));
+            if (!worker->outbox[p]) {
+                fprintf(stderr, "[Rank 0] Failed to allocate outboxes for thread %d\n", w);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    pthread_barrier_init(&group->step_barrier, NULL, num_workers);
+}
+
+static void freeGroup(struct Group *group) {
+    for (int w = 0; w < group->num_workers; w++) {
+        for (int p = 0; p < 2; p++) {
+            for (int d = 0; d < group->num_workers; d++)
+                free(group->workers[w].outbox[p][d].signals);
+            free(group->workers[w].outbox[p]);
+        }
+    }
+    pthread_barrier_destroy(&group->step_barrier);
+    free(group->workers);
+    free(group->worker_starts);
+}
+
+// Report one finished replica from the main thread
+static void reportReplica(const struct Group *group, double seconds) {
+    long long min_processed = 0, max_processed = 0;
+    mergeWorkerStats(group, &min_processed, &max_processed);
+    brain_nodes = group->nodes;
+    elapsed_ns = group->elapsed_ns;
+
+    char report_file[512];
+    replicaReportName(report_file, sizeof(report_file), group->replica);
+    generateReport(report_file);
+
+    if (sim_options.replicas > 1) {
+        recordReplica(group->replica, 0, num_brain_nodes);
+        return;
+    }
+
+    printf("\n Simulation complete.\n");
+    printf(" Report saved to: %s\n", report_file);
+    printf(" Iterations: %d (max %d/ns, min %d/ns)\n",
+           group->total_iterations, group->max_iteration_per_ns, group->min_iteration_per_ns);
+    printf(" Total simulation time: %.6f seconds\n", seconds);
+    printf(" Signals processed per thread: min %lld, max %lld over %d threads\n",
+           min_processed, max_processed, group->num_workers);
+    reportStats(sim_options.stats_json);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3 || parseOptions(argc, argv) != 0) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    ignoreMpiOptions();
+
+    loadBrainGraph(argv[1]);
+    reorderNodes(sim_options.reorder);
+    linkNodesToEdges();
+    if (sim_options.edge_format == EDGE_COMPACT)
+        buildCompactEdges();
+
+    if (!brain_nodes || !edges || num_brain_nodes == 0 || num_edges == 0) {
+        fprintf(stderr, "[Rank 0] Invalid brain graph structure\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("[Rank 0] Loaded: neurons=%d nerves=%d nodes=%d edges=%d\n",
+           num_neurons, num_nerves, num_brain_nodes, num_edges);
+
+    // --- One group of workers per concurrent replica ---
+    int threads = sim_options.threads;
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (int)online : 1;
+    }
+    if (threads > MAX_WORKERS) threads = MAX_WORKERS;
+
+    int replicas = sim_options.replicas;
+    num_groups = replicas < threads ? replicas : threads;
+    int group_size = threads / num_groups;
+    if (group_size > num_brain_nodes) group_size = num_brain_nodes;
+
+    struct NeuronNerveStruct *graph_nodes = brain_nodes;
+    groups = calloc(num_groups, sizeof(struct Group));
+    if (!groups) {
+        fprintf(stderr, "[Rank 0] Failed to allocate %d replica groups\n", num_groups);
+        return EXIT_FAILURE;
+    }
+    for (int g = 0; g < num_groups; g++)
+        initGroup(&groups[g], group_size, g == 0 ? graph_nodes : copyNodeState());
+
+    printf("\n--- Shared-Memory Brain Simulation ---\n");
+    if (replicas > 1)
+        printf("Threads: %d | Replicas: %d (%d at a time, %d threads each) | Brain Nodes: %d | Simulating %s ns\n",
+               num_groups * group_size, replicas, num_groups, group_size, num_brain_nodes, argv[2]);
+    else
+        printf("Threads: %d | Brain Nodes: %d | Simulating %s ns\n", group_size, num_brain_nodes, argv[2]);
+    fflush(stdout);
+
+    num_ns_to_simulate = atoi(argv[2]);
+    getBaseSeed();
+    if (replicas > 1)
+        initEnsemble(replicas);
+
+    // --- Waves of concurrent replicas ---
+    for (int first = 0; first < replicas; first += num_groups) {
+        int active = replicas - first < num_groups ? replicas - first : num_groups;
+        double start_time = MPI_Wtime();
+
+        for (int g = 0; g < active; g++) {
+            struct Group *group = &groups[g];
+            group->replica = first + g;
+            group->max_iteration_per_ns = group->min_iteration_per_ns = -1;
+            if (first > 0) {
+                brain_nodes = group->nodes;
+                resetNodeState();
+            }
+            for (int w = 0; w < group->num_workers; w++) {
+                if (pthread_create(&group->workers[w].thread, NULL, runWorker, &group->workers[w]) != 0) {
+                    fprintf(stderr, "[Rank 0] Failed to start worker thread %d of replica %d\n", w, group->replica);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+        for (int g = 0; g < active; g++)
+            for (int w = 0; w < groups[g].num_workers; w++)
+                pthread_join(groups[g].workers[w].thread, NULL);
+
+        double seconds = MPI_Wtime() - start_time;
+        for (int g = 0; g < active; g++)
+            reportReplica(&groups[g], seconds);
+    }
+
+    brain_nodes = graph_nodes;
+    if (replicas > 1) {
+        reportEnsemble(sim_options.stats_json);
+        freeEnsemble();
+    }
+
+    for (int g = 0; g < num_groups; g++) {
+        if (g > 0)
+            freeNodeState(groups[g].nodes);
+        freeGroup(&groups[g]);
+    }
+    free(groups);
+
+    freeMemory();
+    freeNodeIdIndex();
+    freeNodeOrder();
+    freeCompactEdges();
+    return EXIT_SUCCESS;
+}
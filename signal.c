@@ -0,0 +1,76 @@
+// -------------------------------
+// signal.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+#include "brain.h"
+
+// -------------------------------
+// Random number state (xoshiro256**)
+// Kept explicit rather than rand() so it can be checkpointed, and one
+// stream per worker thread in the shared-memory engine
+// -------------------------------
+static WORKER_LOCAL uint64_t random_state[4] = { 1, 2, 3, 4 };
+
+static uint64_t rotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t nextRandom() {
+    uint64_t result = rotateLeft(random_state[1] * 5, 7) * 9;
+    uint64_t t = random_state[1] << 17;
+    random_state[2] ^= random_state[0];
+    random_state[3] ^= random_state[1];
+    random_state[1] ^= random_state[2];
+    random_state[0] ^= random_state[3];
+    random_state[2] ^= t;
+    random_state[3] = rotateLeft(random_state[3], 45);
+    return result;
+}
+
+// Expand a 64-bit seed into the full state with splitmix64
+void seedRandom(uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        random_state[i] = z ^ (z >> 31);
+    }
+}
+
+void getRandomState(uint64_t state[4]) {
+    for (int i = 0; i < 4; i++)
+        state[i] = random_state[i];
+}
+
+void setRandomState(const uint64_t state[4]) {
+    for (int i = 0; i < 4; i++)
+        random_state[i] = state[i];
+}
+
+void initialize_random() {
+    seedRandom((uint64_t)time(NULL));
+}
+
+// Random integer in [min, max)
+int getRandomInteger(int min, int max) {
+    if (max <= min) return min;
+    return min + (int)(((nextRandom() >> 32) * (uint64_t)(max - min)) >> 32);
+}
+
+// Random float in [0, max_val]
+float generateDecimalRandomNumber(int max_val) {
+    return (float)((nextRandom() >> 40) * (1.0 / 16777215.0)) * max_val;
+}
+
+// -------------------------------
+// Wall-clock seconds
+// -------------------------------
+time_t getCurrentSeconds() {
+    struct timeval curr_time;
+    gettimeofday(&curr_time, NULL);
+    return curr_time.tv_sec;
+}
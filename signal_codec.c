@@ -0,0 +1,210 @@
+// -------------------------------
+// signal_codec.c
+// -------------------------------
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brain.h"
+
+// A batch on the wire is laid out as:
+//   1 byte      precision mode
+//   varint      number of signals
+//   per signal  varint((target delta << SIGNAL_TYPE_BITS) | type), then the value
+//               as 4 (fp32) or 2 (fp16/bf16) little-endian bytes
+// Targets are rank-local indices sorted ascending, so deltas are usually a byte.
+
+#if NUM_SIGNAL_TYPES > (1 << SIGNAL_TYPE_BITS)
+#error "SIGNAL_TYPE_BITS too small for NUM_SIGNAL_TYPES"
+#endif
+
+#define MAX_VARINT_BYTES 5
+
+// -------------------------------
+// Varint helpers
+// -------------------------------
+static unsigned char *putVarint(unsigned char *out, uint32_t v) {
+    while (v >= 0x80) {
+        *out++ = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    *out++ = (unsigned char)v;
+    return out;
+}
+
+static const unsigned char *getVarint(const unsigned char *in, const unsigned char *end, uint32_t *v) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 7 * MAX_VARINT_BYTES && in < end; shift += 7) {
+        unsigned char b = *in++;
+        result |= (uint32_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) {
+            *v = result;
+            return in;
+        }
+    }
+    return NULL;
+}
+
+// -------------------------------
+// Half-precision conversions
+// -------------------------------
+static uint16_t floatToHalf(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t exp = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = x & 0x7fffff;
+
+    if (((x >> 23) & 0xff) == 0xff)
+        return (uint16_t)(sign | 0x7c00 | (mant ? 0x200 : 0));
+    if (exp >= 31)
+        return (uint16_t)(sign | 0x7c00);
+
+    if (exp <= 0) {
+        // Subnormal half, or underflow to zero
+        if (exp < -10) return (uint16_t)sign;
+        mant |= 0x800000;
+        int shift = 14 - exp;
+        uint32_t half = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t mid = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1))) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    // Round to nearest even; a carry correctly bumps the exponent
+    uint32_t half = sign | ((uint32_t)exp << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) half++;
+    return (uint16_t)half;
+}
+
+static float halfToFloat(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t x;
+
+    if (exp == 0) {
+        float f = (float)mant / 16777216.0f;
+        return sign ? -f : f;
+    } else if (exp == 31) {
+        x = sign | 0x7f800000 | (mant << 13);
+    } else {
+        x = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static uint16_t floatToBfloat(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    if ((x & 0x7fffffff) > 0x7f800000)
+        return (uint16_t)((x >> 16) | 0x40);
+    x += 0x7fff + ((x >> 16) & 1);
+    return (uint16_t)(x >> 16);
+}
+
+static float bfloatToFloat(uint16_t b) {
+    uint32_t x = (uint32_t)b << 16;
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static int valueBytes(enum SignalPrecision precision) {
+    return precision == PRECISION_FP32 ? 4 : 2;
+}
+
+// -------------------------------
+// Sort order for batch targets
+// -------------------------------
+static int compareWireSignals(const void *a, const void *b) {
+    int ia = ((const struct WireSignal *)a)->local_idx;
+    int ib = ((const struct WireSignal *)b)->local_idx;
+    return (ia > ib) - (ia < ib);
+}
+
+// -------------------------------
+// Upper bound on the encoded size of a batch
+// -------------------------------
+size_t maxEncodedBatchSize(int count) {
+    return 1 + MAX_VARINT_BYTES + (size_t)count * (MAX_VARINT_BYTES + 4);
+}
+
+// -------------------------------
+// Encode a batch (sorts signals in place)
+// -------------------------------
+size_t encodeSignalBatch(struct WireSignal *signals, int count, enum SignalPrecision precision, unsigned char *out) {
+    unsigned char *p = out;
+    *p++ = (unsigned char)precision;
+    p = putVarint(p, (uint32_t)count);
+
+    qsort(signals, count, sizeof(struct WireSignal), compareWireSignals);
+
+    int prev = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t delta = (uint32_t)(signals[i].local_idx - prev);
+        prev = signals[i].local_idx;
+        p = putVarint(p, (delta << SIGNAL_TYPE_BITS) | (uint32_t)signals[i].signal.type);
+
+        float value = signals[i].signal.value;
+        if (precision == PRECISION_FP32) {
+            uint32_t bits;
+            memcpy(&bits, &value, sizeof(bits));
+            for (int b = 0; b < 4; b++)
+                *p++ = (unsigned char)(bits >> (8 * b));
+        } else {
+            uint16_t bits = (precision == PRECISION_FP16) ? floatToHalf(value) : floatToBfloat(value);
+            *p++ = (unsigned char)bits;
+            *p++ = (unsigned char)(bits >> 8);
+        }
+    }
+
+    return (size_t)(p - out);
+}
+
+// -------------------------------
+// Decode a batch, handing each signal to deliver()
+// Returns the number of signals, or -1 if the batch is malformed
+// -------------------------------
+int decodeSignalBatch(const unsigned char *in, size_t len, void (*deliver)(int local_idx, struct SignalStruct signal)) {
+    const unsigned char *end = in + len;
+    if (len < 2) return -1;
+
+    enum SignalPrecision precision = (enum SignalPrecision)*in++;
+    if (precision != PRECISION_FP32 && precision != PRECISION_FP16 && precision != PRECISION_BF16)
+        return -1;
+
+    uint32_t count;
+    if (!(in = getVarint(in, end, &count)))
+        return -1;
+
+    int local_idx = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t key;
+        if (!(in = getVarint(in, end, &key)) || end - in < valueBytes(precision))
+            return -1;
+
+        local_idx += (int)(key >> SIGNAL_TYPE_BITS);
+        struct SignalStruct signal = { .type = (int)(key & ((1u << SIGNAL_TYPE_BITS) - 1)) };
+
+        if (precision == PRECISION_FP32) {
+            uint32_t bits = (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) | ((uint32_t)in[3] << 24);
+            memcpy(&signal.value, &bits, sizeof(bits));
+            in += 4;
+        } else {
+            uint16_t bits = (uint16_t)(in[0] | (in[1] << 8));
+            signal.value = (precision == PRECISION_FP16) ? halfToFloat(bits) : bfloatToFloat(bits);
+            in += 2;
+        }
+
+        deliver(local_idx, signal);
+    }
+
+    return (int)count;
+}
@@ -0,0 +1,117 @@
+// -------------------------------
+// stats.c
+// -------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "brain.h"
+#include <mpi.h>
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+WORKER_LOCAL struct SimStats sim_stats;
+
+static WORKER_LOCAL double phase_started[NUM_PHASES];
+
+static const char *PHASE_NAMES[NUM_PHASES] = {
+    "ns_rollover", "nerve_update", "neuron_update", "send", "receive", "barrier", "rebalance", "drain"
+};
+
+static const char *COUNTER_NAMES[NUM_COUNTERS] = {
+    "signals_generated", "signals_processed", "chunks_local", "chunks_remote", "bytes_sent", "inbox_drops", "peak_inbox_depth", "nodes_migrated", "rma_fallbacks"
+};
+
+const char *phaseName(enum Phase phase) {
+    return PHASE_NAMES[phase];
+}
+
+// -------------------------------
+// Phase timers
+// -------------------------------
+void phaseBegin(enum Phase phase) {
+    phase_started[phase] = MPI_Wtime();
+}
+
+void phaseEnd(enum Phase phase) {
+    double now = MPI_Wtime();
+    sim_stats.phase_time[phase] += now - phase_started[phase];
+#ifndef SHM_ENGINE
+    if (sim_options.trace_file)
+        traceRecord(phase, phase_started[phase], now);
+#endif
+}
+
+// -------------------------------
+// Reduce per-rank stats to min/mean/max on rank 0,
+// print them and optionally dump them as JSON
+// -------------------------------
+void reportStats(const char *json_filename) {
+    double t_min[NUM_PHASES], t_max[NUM_PHASES], t_sum[NUM_PHASES];
+    long long c_min[NUM_COUNTERS], c_max[NUM_COUNTERS], c_sum[NUM_COUNTERS];
+    long long rss_kb, rss_max, rss_sum;
+    double run_time;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    rss_kb = usage.ru_maxrss;
+
+    MPI_Reduce(sim_stats.phase_time, t_min, NUM_PHASES, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(sim_stats.phase_time, t_max, NUM_PHASES, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(sim_stats.phase_time, t_sum, NUM_PHASES, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(sim_stats.counters, c_min, NUM_COUNTERS, MPI_LONG_LONG, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(sim_stats.counters, c_max, NUM_COUNTERS, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(sim_stats.counters, c_sum, NUM_COUNTERS, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&rss_kb, &rss_max, 1, MPI_LONG_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&rss_kb, &rss_sum, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&sim_stats.run_time, &run_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if (rank != 0)
+        return;
+
+    // Peaks don't add up across ranks: the run's peak is the largest one
+    long long c_total[NUM_COUNTERS];
+    for (int c = 0; c < NUM_COUNTERS; c++)
+        c_total[c] = c == STAT_PEAK_INBOX ? c_max[c] : c_sum[c];
+
+    double signals_per_second = run_time > 0 ? c_sum[STAT_SIGNALS_PROCESSED] / run_time : 0.0;
+    printf("\n Throughput: %.0f signals/s over %d iterations | Peak RSS: %lld KB max/rank, %lld KB total\n",
+           signals_per_second, sim_stats.iterations, rss_max, rss_sum);
+
+    printf("\n Per-rank phase times (s):      min          mean         max\n");
+    for (int p = 0; p < NUM_PHASES; p++)
+        printf("   %-20s %12.6f %12.6f %12.6f\n", PHASE_NAMES[p], t_min[p], t_sum[p] / size, t_max[p]);
+
+    printf(" Per-rank counters:               min          mean         max         total\n");
+    for (int c = 0; c < NUM_COUNTERS; c++)
+        printf("   %-20s %12lld %12.1f %12lld %13lld\n", COUNTER_NAMES[c],
+               c_min[c], (double)c_sum[c] / size, c_max[c], c_total[c]);
+
+    if (!json_filename)
+        return;
+
+    FILE *out = fopen(json_filename, "w");
+    if (!out) {
+        fprintf(stderr, "[Rank %d] Failed to open stats file: %s\n", rank, json_filename);
+        return;
+    }
+
+    fprintf(out, "{\n  \"ranks\": %d,\n", size);
+    fprintf(out, "  \"run\": {\"iterations\": %d, \"seconds\": %.6f, \"signals_per_second\": %.3f, "
+                 "\"max_rss_kb\": %lld, \"total_rss_kb\": %lld},\n",
+            sim_stats.iterations, run_time, signals_per_second, rss_max, rss_sum);
+    fprintf(out, "  \"phases\": {\n");
+    for (int p = 0; p < NUM_PHASES; p++)
+        fprintf(out, "    \"%s\": {\"min\": %.9f, \"mean\": %.9f, \"max\": %.9f}%s\n",
+                PHASE_NAMES[p], t_min[p], t_sum[p] / size, t_max[p], p + 1 < NUM_PHASES ? "," : "");
+    fprintf(out, "  },\n  \"counters\": {\n");
+    for (int c = 0; c < NUM_COUNTERS; c++)
+        fprintf(out, "    \"%s\": {\"min\": %lld, \"mean\": %.3f, \"max\": %lld, \"total\": %lld}%s\n",
+                COUNTER_NAMES[c], c_min[c], (double)c_sum[c] / size, c_max[c], c_total[c],
+                c + 1 < NUM_COUNTERS ? "," : "");
+    fprintf(out, "  }\n}\n");
+    fclose(out);
+}
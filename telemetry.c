@@ -0,0 +1,299 @@
+// -------------------------------
+// telemetry.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "brain.h"
+#include <mpi.h>
+
+// At every ns rollover each rank starts non-blocking reductions of its
+// per-ns aggregates to rank 0. They are completed at the next rollover
+// (or at the end of the run), and rank 0 hands the finished record to a
+// writer thread that appends one JSON line per ns. Neither the
+// reductions nor the file I/O sit on the simulation loop's path.
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+// Layout of the summed vector
+enum {
+    TM_SIGNALS,
+    TM_GENERATED,
+    TM_DROPS,
+    TM_INPUTS,
+    TM_OUTPUTS = TM_INPUTS + NUM_SIGNAL_TYPES,
+    TM_FIELDS = TM_OUTPUTS + NUM_SIGNAL_TYPES
+};
+
+struct TelemetryRecord {
+    int ns;
+    int iterations;
+    int total_iterations;
+    long long sums[TM_FIELDS];
+    int *top;                  // top_k (signals, id) pairs, busiest first
+    int top_count;
+    struct TelemetryRecord *next;
+};
+
+static int top_k = 0;
+static int start_idx, end_idx;
+
+// Cumulative values at the previous rollover, to turn counters into deltas
+static long long last_inputs[NUM_SIGNAL_TYPES], last_outputs[NUM_SIGNAL_TYPES];
+static long long last_generated = 0, last_drops = 0;
+
+// Nerve counts of the current ns that left with migrated nodes
+static long long carried_inputs[NUM_SIGNAL_TYPES], carried_outputs[NUM_SIGNAL_TYPES];
+
+// Reduction in flight
+static MPI_Request pending[2];
+static int has_pending = 0;
+static long long send_sums[TM_FIELDS];
+static int *send_top = NULL;
+static int *recv_top = NULL;
+static struct TelemetryRecord *pending_record = NULL;
+
+// Writer thread queue (rank 0 only)
+static pthread_t writer;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_ready = PTHREAD_COND_INITIALIZER;
+static struct TelemetryRecord *queue_head = NULL, *queue_tail = NULL;
+static int writer_done = 0;
+static FILE *out = NULL;
+
+static void *allocOrDie(size_t bytes) {
+    void *p = malloc(bytes);
+    if (!p) {
+        fprintf(stderr, "[Rank %d] Failed to allocate telemetry buffers\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    return p;
+}
+
+static void sumNerveCounters(long long inputs[NUM_SIGNAL_TYPES], long long outputs[NUM_SIGNAL_TYPES]) {
+    memset(inputs, 0, NUM_SIGNAL_TYPES * sizeof(long long));
+    memset(outputs, 0, NUM_SIGNAL_TYPES * sizeof(long long));
+    for (int i = start_idx; i < end_idx; i++) {
+        if (brain_nodes[i].node_type != NERVE)
+            continue;
+        for (int t = 0; t < NUM_SIGNAL_TYPES; t++) {
+            inputs[t] += brain_nodes[i].num_nerve_inputs[t];
+            outputs[t] += brain_nodes[i].num_nerve_outputs[t];
+        }
+    }
+}
+
+static void writeRecord(const struct TelemetryRecord *rec) {
+    fprintf(out, "{\"ns\": %d, \"iterations\": %d, \"total_iterations\": %d, "
+                 "\"signals\": %lld, \"signals_generated\": %lld, \"inbox_drops\": %lld",
+            rec->ns, rec->iterations, rec->total_iterations,
+            rec->sums[TM_SIGNALS], rec->sums[TM_GENERATED], rec->sums[TM_DROPS]);
+
+    fprintf(out, ", \"nerve_inputs\": [");
+    for (int t = 0; t < NUM_SIGNAL_TYPES; t++)
+        fprintf(out, "%s%lld", t ? ", " : "", rec->sums[TM_INPUTS + t]);
+    fprintf(out, "], \"nerve_outputs\": [");
+    for (int t = 0; t < NUM_SIGNAL_TYPES; t++)
+        fprintf(out, "%s%lld", t ? ", " : "", rec->sums[TM_OUTPUTS + t]);
+
+    fprintf(out, "], \"top_neurons\": [");
+    for (int k = 0; k < rec->top_count; k++)
+        fprintf(out, "%s{\"id\": %d, \"signals\": %d}", k ? ", " : "", rec->top[2 * k + 1], rec->top[2 * k]);
+    fprintf(out, "]}\n");
+}
+
+static void *writerMain(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&queue_lock);
+    for (;;) {
+        while (!queue_head && !writer_done)
+            pthread_cond_wait(&queue_ready, &queue_lock);
+        if (!queue_head)
+            break;
+
+        struct TelemetryRecord *rec = queue_head;
+        queue_head = rec->next;
+        if (!queue_head)
+            queue_tail = NULL;
+
+        pthread_mutex_unlock(&queue_lock);
+        writeRecord(rec);
+        fflush(out);
+        free(rec->top);
+        free(rec);
+        pthread_mutex_lock(&queue_lock);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+static void enqueueRecord(struct TelemetryRecord *rec) {
+    rec->next = NULL;
+    pthread_mutex_lock(&queue_lock);
+    if (queue_tail)
+        queue_tail->next = rec;
+    else
+        queue_head = rec;
+    queue_tail = rec;
+    pthread_cond_signal(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+// -------------------------------
+// Keep the k busiest (signals, id) pairs in descending order
+// -------------------------------
+static void insertTop(int *top, int *count, int k, int signals, int id) {
+    if (*count == k && signals <= top[2 * (k - 1)])
+        return;
+    int pos = *count < k ? (*count)++ : k - 1;
+    while (pos > 0 && top[2 * (pos - 1)] < signals) {
+        top[2 * pos] = top[2 * (pos - 1)];
+        top[2 * pos + 1] = top[2 * (pos - 1) + 1];
+        pos--;
+    }
+    top[2 * pos] = signals;
+    top[2 * pos + 1] = id;
+}
+
+// -------------------------------
+// Finish the reduction in flight and pass it to the writer
+// -------------------------------
+static void completePending() {
+    if (!has_pending)
+        return;
+    MPI_Waitall(2, pending, MPI_STATUSES_IGNORE);
+    has_pending = 0;
+
+    if (rank != 0)
+        return;
+
+    struct TelemetryRecord *rec = pending_record;
+    pending_record = NULL;
+    rec->top = allocOrDie((size_t)2 * top_k * sizeof(int));
+    rec->top_count = 0;
+    for (int i = 0; i < size * top_k; i++) {
+        if (recv_top[2 * i + 1] >= 0)
+            insertTop(rec->top, &rec->top_count, top_k, recv_top[2 * i], recv_top[2 * i + 1]);
+    }
+    enqueueRecord(rec);
+}
+
+// -------------------------------
+// Open the stream and start the writer thread. Called once the
+// owned range (and any restored state) is in place
+// -------------------------------
+void initTelemetry(const char *filename, int k, int first_idx, int last_idx) {
+    top_k = k;
+    start_idx = first_idx;
+    end_idx = last_idx;
+
+    sumNerveCounters(last_inputs, last_outputs);
+    send_top = allocOrDie((size_t)2 * top_k * sizeof(int));
+    if (rank == 0)
+        recv_top = allocOrDie((size_t)2 * top_k * size * sizeof(int));
+
+    if (rank != 0)
+        return;
+
+    out = fopen(filename, "w");
+    if (!out) {
+        fprintf(stderr, "[Rank %d] Failed to open telemetry file: %s\n", rank, filename);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (pthread_create(&writer, NULL, writerMain, NULL) != 0) {
+        fprintf(stderr, "[Rank %d] Failed to start telemetry writer thread\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// -------------------------------
+// Snapshot the ns that just ended. Must run before signals_this_ns
+// is rotated
+// -------------------------------
+void telemetryRecordNs(int ns, int iterations, int total_iterations) {
+    completePending();
+
+    long long inputs[NUM_SIGNAL_TYPES], outputs[NUM_SIGNAL_TYPES];
+    sumNerveCounters(inputs, outputs);
+
+    memset(send_sums, 0, sizeof(send_sums));
+    int top_count = 0;
+    for (int i = start_idx; i < end_idx; i++) {
+        int signals = brain_nodes[i].signals_this_ns;
+        send_sums[TM_SIGNALS] += signals;
+        if (brain_nodes[i].node_type == NEURON && signals > 0)
+            insertTop(send_top, &top_count, top_k, signals, brain_nodes[i].id);
+    }
+    for (int k = top_count; k < top_k; k++) {
+        send_top[2 * k] = 0;
+        send_top[2 * k + 1] = -1;
+    }
+
+    send_sums[TM_GENERATED] = sim_stats.counters[STAT_SIGNALS_GENERATED] - last_generated;
+    send_sums[TM_DROPS] = sim_stats.counters[STAT_INBOX_DROPS] - last_drops;
+    last_generated = sim_stats.counters[STAT_SIGNALS_GENERATED];
+    last_drops = sim_stats.counters[STAT_INBOX_DROPS];
+    for (int t = 0; t < NUM_SIGNAL_TYPES; t++) {
+        send_sums[TM_INPUTS + t] = inputs[t] - last_inputs[t] + carried_inputs[t];
+        send_sums[TM_OUTPUTS + t] = outputs[t] - last_outputs[t] + carried_outputs[t];
+        last_inputs[t] = inputs[t];
+        last_outputs[t] = outputs[t];
+        carried_inputs[t] = carried_outputs[t] = 0;
+    }
+
+    if (rank == 0) {
+        pending_record = allocOrDie(sizeof(struct TelemetryRecord));
+        pending_record->ns = ns;
+        pending_record->iterations = iterations;
+        pending_record->total_iterations = total_iterations;
+    }
+
+    MPI_Ireduce(send_sums, rank == 0 ? pending_record->sums : NULL, TM_FIELDS,
+                MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD, &pending[0]);
+    MPI_Igather(send_top, 2 * top_k, MPI_INT, recv_top, 2 * top_k, MPI_INT,
+                0, MPI_COMM_WORLD, &pending[1]);
+    has_pending = 1;
+}
+
+// -------------------------------
+// The owned range changed: keep what this ns already counted on the old
+// range and measure the new one from its current totals
+// -------------------------------
+void telemetrySetRange(int first_idx, int last_idx) {
+    long long inputs[NUM_SIGNAL_TYPES], outputs[NUM_SIGNAL_TYPES];
+    sumNerveCounters(inputs, outputs);
+    for (int t = 0; t < NUM_SIGNAL_TYPES; t++) {
+        carried_inputs[t] += inputs[t] - last_inputs[t];
+        carried_outputs[t] += outputs[t] - last_outputs[t];
+    }
+
+    start_idx = first_idx;
+    end_idx = last_idx;
+    sumNerveCounters(last_inputs, last_outputs);
+}
+
+// -------------------------------
+// Complete the last reduction, drain the queue and stop the writer
+// -------------------------------
+void finishTelemetry() {
+    completePending();
+    free(send_top);
+    free(recv_top);
+    send_top = recv_top = NULL;
+
+    if (rank != 0)
+        return;
+
+    pthread_mutex_lock(&queue_lock);
+    writer_done = 1;
+    pthread_cond_signal(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+    pthread_join(writer, NULL);
+    fclose(out);
+    out = NULL;
+}
@@ -0,0 +1,156 @@
+// -------------------------------
+// trace.c
+// -------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "brain.h"
+#include <mpi.h>
+
+// -------------------------------
+// External Globals
+// -------------------------------
+extern int rank, size;
+
+// -------------------------------
+// One completed phase on this rank
+// -------------------------------
+struct TraceEvent {
+    double begin, end;
+    int iteration;
+    int phase;
+};
+
+static struct TraceEvent *ring = NULL;
+static int ring_capacity = 0;
+static long long ring_written = 0;
+static int current_iteration = 0;
+static double trace_origin = 0.0;
+
+// -------------------------------
+// Allocate the ring buffer and align the time origin across ranks
+// -------------------------------
+void initTrace(int capacity) {
+    ring_capacity = capacity;
+    ring = malloc((size_t)capacity * sizeof(struct TraceEvent));
+    if (!ring) {
+        fprintf(stderr, "[Rank %d] Failed to allocate trace buffer (%d events)\n", rank, capacity);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    trace_origin = MPI_Wtime();
+}
+
+void traceSetIteration(int iteration) {
+    current_iteration = iteration;
+}
+
+// -------------------------------
+// Record a phase; once full the oldest events are overwritten
+// -------------------------------
+void traceRecord(enum Phase phase, double begin, double end) {
+    struct TraceEvent *ev = &ring[ring_written % ring_capacity];
+    ev->begin = begin - trace_origin;
+    ev->end = end - trace_origin;
+    ev->iteration = current_iteration;
+    ev->phase = phase;
+    ring_written++;
+}
+
+// -------------------------------
+// Gather every rank's ring on rank 0 and write a Chrome trace
+// (loadable in chrome://tracing and ui.perfetto.dev)
+// -------------------------------
+void writeTrace(const char *filename) {
+    int count = ring_written < ring_capacity ? (int)ring_written : ring_capacity;
+    int first = ring_written < ring_capacity ? 0 : (int)(ring_written % ring_capacity);
+
+    // Unroll the ring so events are in chronological order
+    struct TraceEvent *ordered = malloc((size_t)(count > 0 ? count : 1) * sizeof(struct TraceEvent));
+    if (!ordered) {
+        fprintf(stderr, "[Rank %d] Failed to allocate trace output buffer\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int i = 0; i < count; i++)
+        ordered[i] = ring[(first + i) % ring_capacity];
+
+    // Events travel as one datatype, so MPI counts them rather than their
+    // bytes; byte sizes are only ever formed in 64 bits
+    MPI_Datatype event_type;
+    MPI_Type_contiguous((int)sizeof(struct TraceEvent), MPI_BYTE, &event_type);
+    MPI_Type_commit(&event_type);
+
+    int *recvcounts = NULL, *displs = NULL;
+    struct TraceEvent *all = NULL;
+    long long total = 0;
+
+    if (rank == 0) {
+        recvcounts = malloc(size * sizeof(int));
+        displs = malloc(size * sizeof(int));
+    }
+    MPI_Gather(&count, 1, MPI_INT, recvcounts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    if (rank == 0) {
+        for (int r = 0; r < size; r++) {
+            if (total + recvcounts[r] > INT_MAX) {
+                fprintf(stderr, "[Rank 0] Merged trace exceeds %d events, lower --trace-events\n", INT_MAX);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            displs[r] = (int)total;
+            total += recvcounts[r];
+        }
+        int64_t total_bytes = (int64_t)total * (int64_t)sizeof(struct TraceEvent);
+        all = malloc(total_bytes > 0 ? (size_t)total_bytes : 1);
+        if (!all) {
+            fprintf(stderr, "[Rank 0] Failed to allocate merged trace (%lld bytes)\n", (long long)total_bytes);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    MPI_Gatherv(ordered, count, event_type, all, recvcounts, displs, event_type, 0, MPI_COMM_WORLD);
+    MPI_Type_free(&event_type);
+
+    if (rank == 0) {
+        FILE *out = fopen(filename, "w");
+        if (!out) {
+            fprintf(stderr, "[Rank 0] Failed to open trace file: %s\n", filename);
+        } else {
+            // Separators go before each element, so any element may be last
+            fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+            for (int r = 0; r < size; r++)
+                fprintf(out, "%s{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": 0, \"args\": {\"name\": \"Rank %d\"}}",
+                        r ? ",\n" : "", r, r);
+
+            int written = 0;
+            for (int r = 0; r < size; r++) {
+                struct TraceEvent *events = all + displs[r];
+                for (int i = 0; i < recvcounts[r]; i++) {
+                    fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": 0, "
+                            "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"iteration\": %d}}",
+                            phaseName(events[i].phase), r,
+                            events[i].begin * 1e6, (events[i].end - events[i].begin) * 1e6,
+                            events[i].iteration);
+                    written++;
+                }
+            }
+            fprintf(out, "\n]}\n");
+            fclose(out);
+            printf(" Trace (%d events) saved to: %s\n", written, filename);
+        }
+
+        free(recvcounts);
+        free(displs);
+        free(all);
+    }
+
+    free(ordered);
+}
+
+void freeTrace() {
+    free(ring);
+    ring = NULL;
+    ring_capacity = 0;
+    ring_written = 0;
+}